@@ -5,3 +5,6 @@ CONFIG -= qt
 
 SOURCES += \
         bst.cpp
+
+HEADERS += \
+        tree.h
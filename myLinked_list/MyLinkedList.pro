@@ -1,14 +1,39 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
     tests.cpp \
-    linkedlist.cpp
+    linkedlist.cpp \
+    dlist.cpp \
+    slabpool.cpp \
+    linkarena.cpp \
+    unrolledlist.cpp \
+    compactlist.cpp \
+    skiplist.cpp \
+    lockfreestack.cpp \
+    lockfreequeue.cpp \
+    reclaim.cpp \
+    lazylist.cpp \
+    conslist.cpp
 
 HEADERS += \
-    linkedlist.h
+    linkedlist.h \
+    dlist.h \
+    slabpool.h \
+    linkarena.h \
+    unrolledlist.h \
+    intrusivelist.h \
+    compactlist.h \
+    skiplist.h \
+    taggedptr.h \
+    lockfreestack.h \
+    lockfreequeue.h \
+    reclaim.h \
+    lazylist.h \
+    conslist.h \
+    traversal.h
 
 win32 {
     QMAKE_CXXFLAGS += -Wa,-mbig-obj
@@ -0,0 +1,128 @@
+// Operations per second on a shared sorted set: LazyList against a sorted
+//   LinkedList behind one mutex, for a read-mostly and an update-heavy mix,
+//   from 1 to 16 threads. Keys are drawn from [0, key_range), and the set
+//   starts half full. Usage: bench_lazylist [operations per thread]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "lazylist.h"
+#include "linkedlist.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const int key_range = 1024;
+
+// Runs body(thread index) on n_threads threads and returns the wall time in seconds.
+template<class Body>
+static double run_threads(int n_threads, Body body)
+{
+    std::thread* threads = new std::thread[n_threads];
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < n_threads; ++t){
+        threads[t] = std::thread(body, t);
+    }
+    for (int t = 0; t < n_threads; ++t){
+        threads[t].join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    delete [] threads;
+    return seconds;
+}
+
+// Sorted set on a plain LinkedList, every operation under one lock.
+class LockedSortedList{
+public:
+    bool insert(Thing t){
+        std::lock_guard<std::mutex> guard(lock);
+        Link **link = &list.head;
+        while (*link != nullptr && (*link)->value.i < t.i){
+            link = &(*link)->next;
+        }
+        if (*link != nullptr && (*link)->value.i == t.i){
+            return false;
+        }
+        Link *node = new Link(t);
+        node->next = *link;
+        *link = node;
+        return true;
+    }
+    bool erase(Thing t){
+        std::lock_guard<std::mutex> guard(lock);
+        Link **link = &list.head;
+        while (*link != nullptr && (*link)->value.i < t.i){
+            link = &(*link)->next;
+        }
+        if (*link == nullptr || (*link)->value.i != t.i){
+            return false;
+        }
+        Link *gone = *link;
+        *link = gone->next;
+        delete gone;
+        return true;
+    }
+    bool contains(Thing t){
+        std::lock_guard<std::mutex> guard(lock);
+        Link *curr = list.head;
+        while (curr != nullptr && curr->value.i < t.i){
+            curr = curr->next;
+        }
+        return curr != nullptr && curr->value.i == t.i;
+    }
+private:
+    std::mutex lock;
+    LinkedList list;
+};
+
+// Operations per second with update_percent of them split evenly between
+// insert and erase, the rest contains.
+template<class Set>
+static double mix(Set& set, int n_threads, size_t ops, unsigned update_percent)
+{
+    for (int k = 0; k < key_range; k += 2){
+        set.insert(Thing(k));
+    }
+    std::atomic<size_t> total_hits(0);
+    double seconds = run_threads(n_threads, [&](int t){
+        uint32_t seed = 2463534242u + t;
+        size_t hits = 0;
+        for (size_t i = 0; i < ops; ++i){
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            Thing key(int((seed >> 8) % key_range));
+            unsigned roll = seed % 100;
+            if (roll < update_percent / 2){
+                hits += set.insert(key);
+            }
+            else if (roll < update_percent){
+                hits += set.erase(key);
+            }
+            else{
+                hits += set.contains(key);
+            }
+        }
+        total_hits += hits;   // Keeps the lookups from being optimised away
+    });
+    return double(ops) * n_threads / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    unsigned mixes[] = {2, 50};
+    for (unsigned update_percent : mixes){
+        std::cout << update_percent << "% updates" << std::endl
+                  << "threads  mutex+LinkedList  LazyList  (M ops/s)" << std::endl;
+        for (int n_threads = 1; n_threads <= 16; n_threads *= 2){
+            LockedSortedList locked;
+            LazyList lazy;
+            std::cout << n_threads << "\t "
+                      << mix(locked, n_threads, ops, update_percent) / 1e6 << "\t\t   "
+                      << mix(lazy, n_threads, ops, update_percent) / 1e6 << std::endl;
+        }
+    }
+    return 0;
+}
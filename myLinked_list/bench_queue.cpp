@@ -0,0 +1,100 @@
+// Throughput of LockFreeQueue against a LinkedList guarded by a mutex
+//   (push_back/pop_front), with half of the threads producing and half
+//   consuming, from 2 to 64 threads.
+//   Usage: bench_queue [items, split over the producers]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "linkedlist.h"
+#include "lockfreequeue.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Runs body(thread index) on n_threads threads and returns the wall time in seconds.
+template<class Body>
+static double run_threads(int n_threads, Body body)
+{
+    std::thread* threads = new std::thread[n_threads];
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < n_threads; ++t){
+        threads[t] = std::thread(body, t);
+    }
+    for (int t = 0; t < n_threads; ++t){
+        threads[t].join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    delete [] threads;
+    return seconds;
+}
+
+// Threads [0, n_threads / 2) push per_producer items each, the rest pop
+// until every item is gone. Returns items per second.
+template<class Push, class Pop>
+static double produce_consume(int n_threads, size_t per_producer, Push push, Pop pop)
+{
+    int producers = n_threads / 2;
+    long long total = (long long)per_producer * producers;
+    std::atomic<long long> consumed(0);
+    std::atomic<long long> sum(0);
+    double seconds = run_threads(n_threads, [&](int t){
+        if (t < producers){
+            for (size_t i = 0; i < per_producer; ++i){
+                push(Thing(int(i)));
+            }
+            return;
+        }
+        Thing out;
+        long long local = 0;
+        while (consumed.load(std::memory_order_relaxed) < total){
+            if (pop(out)){
+                local += out.i;
+                consumed.fetch_add(1, std::memory_order_relaxed);
+            }
+            else{
+                std::this_thread::yield();
+            }
+        }
+        sum += local;
+    });
+    if (sum != (long long)(per_producer * (per_producer - 1) / 2) * producers){
+        std::cerr << "checksum mismatch" << std::endl;
+    }
+    return total / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::cout << "threads  mutex+LinkedList  lock-free  (M items/s)" << std::endl;
+    for (int n_threads = 2; n_threads <= 64; n_threads *= 2){
+        size_t per_producer = items / (n_threads / 2);
+
+        LinkedList list;
+        std::mutex lock;
+        double locked = produce_consume(n_threads, per_producer,
+            [&](Thing t){
+                std::lock_guard<std::mutex> guard(lock);
+                list.push_back(t);
+            },
+            [&](Thing& out){
+                std::lock_guard<std::mutex> guard(lock);
+                if (list.size() == 0){
+                    return false;
+                }
+                out = list.front();
+                list.pop_front();
+                return true;
+            });
+
+        LockFreeQueue queue;
+        double lock_free = produce_consume(n_threads, per_producer,
+            [&](Thing t){ queue.push(t); },
+            [&](Thing& out){ return queue.try_pop(out); });
+
+        std::cout << n_threads << "\t " << locked / 1e6 << "\t\t   " << lock_free / 1e6 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Read-side cost of EpochDomain and HazardDomain: threads walk a shared
+//   chain of nodes unprotected, inside one epoch guard per walk, and with
+//   hand-over-hand hazard pointers. Also times retiring Links, frees included.
+//   Usage: bench_reclaim [walks per thread]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "linkedlist.h"
+#include "reclaim.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Node{
+    std::atomic<Node*> next;
+    Thing value;
+};
+
+static const size_t chain_length = 1000;
+
+// Runs body(thread index) on n_threads threads and returns the wall time in seconds.
+template<class Body>
+static double run_threads(int n_threads, Body body)
+{
+    std::thread* threads = new std::thread[n_threads];
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < n_threads; ++t){
+        threads[t] = std::thread(body, t);
+    }
+    for (int t = 0; t < n_threads; ++t){
+        threads[t].join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    delete [] threads;
+    return seconds;
+}
+
+static long long walk_plain(std::atomic<Node*>& head)
+{
+    long long sum = 0;
+    for (Node *curr = head.load(std::memory_order_acquire); curr != nullptr;
+         curr = curr->next.load(std::memory_order_acquire)){
+        sum += curr->value.i;
+    }
+    return sum;
+}
+
+static long long walk_epoch(std::atomic<Node*>& head, EpochDomain& domain)
+{
+    EpochDomain::Guard guard(domain);
+    return walk_plain(head);
+}
+
+static long long walk_hazard(std::atomic<Node*>& head, HazardDomain& domain)
+{
+    long long sum = 0;
+    size_t slot = 0;
+    for (Node *curr = domain.protect(slot, head); curr != nullptr;
+         curr = domain.protect(slot, curr->next)){
+        sum += curr->value.i;
+        slot ^= 1;   // Keep the current node protected while loading the next one
+    }
+    domain.clear_all();
+    return sum;
+}
+
+// Nanoseconds per node visited.
+template<class Walk>
+static double read_cost(int n_threads, size_t walks, Walk walk)
+{
+    double seconds = run_threads(n_threads, [&](int){
+        long long sum = 0;
+        for (size_t i = 0; i < walks; ++i){
+            sum += walk();
+        }
+        if (sum != (long long)(walks * chain_length * (chain_length - 1) / 2)){
+            std::cerr << "checksum mismatch" << std::endl;
+        }
+    });
+    return seconds * 1e9 / (double(walks) * chain_length);
+}
+
+// Nanoseconds per retired Link, including the batched frees.
+template<class Domain>
+static double retire_cost(int n_threads, size_t links)
+{
+    Domain domain;
+    return run_threads(n_threads, [&](int){
+        for (size_t i = 0; i < links; ++i){
+            domain.retire(new Link(Thing(int(i))));
+        }
+    }) * 1e9 / double(links);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t walks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+
+    std::atomic<Node*> head(nullptr);
+    for (size_t i = chain_length; i-- > 0;){
+        Node *node = new Node;
+        node->value = Thing(int(i));
+        node->next.store(head.load());
+        head.store(node);
+    }
+
+    EpochDomain epochs;
+    HazardDomain hazards;
+    std::cout << "threads  plain  epoch  hazard  (ns per node read)   epoch  hazard  (ns per retire)" << std::endl;
+    for (int n_threads = 1; n_threads <= 8; n_threads *= 2){
+        std::cout << n_threads << "\t "
+                  << read_cost(n_threads, walks, [&]{ return walk_plain(head); }) << "  "
+                  << read_cost(n_threads, walks, [&]{ return walk_epoch(head, epochs); }) << "  "
+                  << read_cost(n_threads, walks, [&]{ return walk_hazard(head, hazards); }) << "\t\t\t "
+                  << retire_cost<EpochDomain>(n_threads, walks * 100) << "  "
+                  << retire_cost<HazardDomain>(n_threads, walks * 100) << std::endl;
+    }
+
+    Node *curr = head.load();
+    while (curr != nullptr){
+        Node *next = curr->next.load();
+        delete curr;
+        curr = next;
+    }
+    return 0;
+}
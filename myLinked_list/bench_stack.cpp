@@ -0,0 +1,81 @@
+// Push/pop throughput of LockFreeStack against a LinkedList guarded by a
+//   mutex, from 1 to 64 threads. Every thread pushes and then pops, so the
+//   stack stays small and all threads fight over the top.
+//   Usage: bench_stack [push/pop pairs, split over the threads]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "linkedlist.h"
+#include "lockfreestack.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Runs body(thread index) on n_threads threads and returns the wall time in seconds.
+template<class Body>
+static double run_threads(int n_threads, Body body)
+{
+    std::thread* threads = new std::thread[n_threads];
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < n_threads; ++t){
+        threads[t] = std::thread(body, t);
+    }
+    for (int t = 0; t < n_threads; ++t){
+        threads[t].join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    delete [] threads;
+    return seconds;
+}
+
+static double locked_list(int n_threads, size_t ops)
+{
+    LinkedList list;
+    std::mutex lock;
+    double seconds = run_threads(n_threads, [&](int t){
+        long long sum = 0;
+        for (size_t i = 0; i < ops; ++i){
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                list.push_front(Thing(t));
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            sum += list.front().i;
+            list.pop_front();
+        }
+        (void) sum;
+    });
+    return 2.0 * ops * n_threads / seconds;
+}
+
+static double lock_free(int n_threads, size_t ops, bool eliminate)
+{
+    LockFreeStack stack(eliminate);
+    double seconds = run_threads(n_threads, [&](int t){
+        long long sum = 0;
+        Thing out;
+        for (size_t i = 0; i < ops; ++i){
+            stack.push(Thing(t));
+            while (!stack.try_pop(out)){}
+            sum += out.i;
+        }
+        (void) sum;
+    });
+    return 2.0 * ops * n_threads / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t total = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::cout << "threads  mutex+LinkedList  lock-free  lock-free+elimination  (M ops/s)" << std::endl;
+    for (int n_threads = 1; n_threads <= 64; n_threads *= 2){
+        size_t ops = total / n_threads;
+        std::cout << n_threads << "\t "
+                  << locked_list(n_threads, ops) / 1e6 << "\t\t   "
+                  << lock_free(n_threads, ops, false) / 1e6 << "\t      "
+                  << lock_free(n_threads, ops, true) / 1e6 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Nanoseconds per link for summing lists whose links are shuffled through
+//   memory, with the cache flushed before every pass: a plain iterator loop,
+//   chain_accumulate, and for many lists a list-at-a-time walk against
+//   chains_accumulate, and the plain loop again after LinkedList::compact().
+//   Usage: bench_traverse [links in total]
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "linkedlist.h"
+#include "traversal.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t flush_bytes = 64 * 1024 * 1024;
+
+// Allocates n links and chains them in a random order into n_lists lists of
+// about equal length. The first link of each list goes to heads.
+static void build_scattered(size_t n, size_t n_lists, Link** heads)
+{
+    Link** links = new Link*[n];
+    for (size_t i = 0; i < n; ++i){
+        links[i] = new Link(Thing(int(i % 1000)));
+    }
+    uint32_t seed = 2463534242u;
+    for (size_t i = n - 1; i > 0; --i){
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        size_t j = seed % (i + 1);
+        Link* tmp = links[i];
+        links[i] = links[j];
+        links[j] = tmp;
+    }
+    size_t per_list = n / n_lists;
+    for (size_t c = 0; c < n_lists; ++c){
+        size_t first = c * per_list;
+        size_t last = c + 1 == n_lists ? n : first + per_list;
+        for (size_t i = first; i + 1 < last; ++i){
+            links[i]->next = links[i + 1];
+        }
+        links[last - 1]->next = nullptr;
+        heads[c] = links[first];
+    }
+    delete [] links;
+}
+
+static void free_lists(Link** heads, size_t n_lists)
+{
+    for (size_t c = 0; c < n_lists; ++c){
+        while (heads[c] != nullptr){
+            Link* next = heads[c]->next;
+            delete heads[c];
+            heads[c] = next;
+        }
+    }
+}
+
+// Writes over a buffer larger than the last level cache.
+static void flush_cache(char* buffer)
+{
+    static char fill = 0;
+    std::memset(buffer, ++fill, flush_bytes);
+}
+
+// Flushes the cache, then returns the time body() takes in seconds.
+template<class Body>
+static double cold_run(char* buffer, Body body)
+{
+    flush_cache(buffer);
+    Clock::time_point start = Clock::now();
+    body();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    char* buffer = new char[flush_bytes];
+    volatile long sink = 0;   // Keeps the sums from being optimised away
+
+    std::cout << "one list of " << n << " links (ns per link)" << std::endl;
+    Link* head;
+    build_scattered(n, 1, &head);
+    LinkedList list;
+    list.head = head;
+    double plain = cold_run(buffer, [&]{
+        long sum = 0;
+        for (Thing& t : list){
+            sum += t.i;
+        }
+        sink = sink + sum;
+    });
+    double prefetched = cold_run(buffer, [&]{
+        sink = sink + chain_accumulate(list.head, 0L, [](long acc, const Thing& t){ return acc + t.i; });
+    });
+    std::cout << "iterator          " << plain * 1e9 / n << std::endl
+              << "chain_accumulate  " << prefetched * 1e9 / n << std::endl;
+    double fragmentation = list.fragmentation();
+    list.compact();
+    double compacted = cold_run(buffer, [&]{
+        long sum = 0;
+        for (Thing& t : list){
+            sum += t.i;
+        }
+        sink = sink + sum;
+    });
+    std::cout << "after compact()   " << compacted * 1e9 / n
+              << "  (fragmentation " << fragmentation << " -> " << list.fragmentation() << ")" << std::endl;
+    head = list.head;
+    list.head = nullptr;
+    free_lists(&head, 1);
+
+    std::cout << "lists  one at a time  lock-step  (ns per link)" << std::endl;
+    for (size_t n_lists = 2; n_lists <= 64; n_lists *= 2){
+        Link** heads = new Link*[n_lists];
+        long* sums = new long[n_lists];
+        build_scattered(n, n_lists, heads);
+        double sequential = cold_run(buffer, [&]{
+            for (size_t c = 0; c < n_lists; ++c){
+                sums[c] = chain_accumulate(heads[c], 0L, [](long acc, const Thing& t){ return acc + t.i; });
+            }
+        });
+        sink = sink + sums[0];
+        double lockstep = cold_run(buffer, [&]{
+            for (size_t c = 0; c < n_lists; ++c){
+                sums[c] = 0;
+            }
+            chains_accumulate(heads, n_lists, sums, [](long acc, const Thing& t){ return acc + t.i; });
+        });
+        sink = sink + sums[0];
+        std::cout << n_lists << "\t " << sequential * 1e9 / n << "\t\t" << lockstep * 1e9 / n << std::endl;
+        free_lists(heads, n_lists);
+        delete [] sums;
+        delete [] heads;
+    }
+    delete [] buffer;
+    return 0;
+}
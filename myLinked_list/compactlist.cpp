@@ -0,0 +1,316 @@
+#include "compactlist.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * @brief CompactListIterator::operator*
+ * @return Return a reference to the thing in the node that we're pointing to
+ */
+Thing &CompactListIterator::operator*()
+{
+    return nodes[index].value;
+}
+
+/**
+ * @brief CompactListIterator::operator++
+ * Make the current iterator point to the next node in the list.
+ * @return Return a reference to this object.
+ */
+CompactListIterator &CompactListIterator::operator++()
+{
+    index = nodes[index].next;
+    return *this;
+}
+
+/**
+ * @brief CompactList::CompactList
+ * Construct an empty list with no node array.
+ */
+CompactList::CompactList()
+{
+}
+
+/**
+ * @brief CompactList::~CompactList
+ * Free the node array. Every node goes with it.
+ */
+CompactList::~CompactList()
+{
+    std::free(nodes);
+}
+
+/**
+ * @brief CompactList::push_front
+ * @param t
+ * Push t to the front of the list
+ */
+void CompactList::push_front(Thing t)
+{
+    uint32_t i = new_node(t);
+    nodes[i].next = head;
+    head = i;
+    if (tail == CompactNode::none){
+        tail = i;
+    }
+    ++count;
+}
+
+/**
+ * @brief CompactList::pop_front
+ * Remove the front item in the list. Never called on an empty list.
+ */
+void CompactList::pop_front()
+{
+    uint32_t i = head;
+    head = nodes[i].next;
+    if (head == CompactNode::none){
+        tail = CompactNode::none;
+    }
+    free_node(i);
+    --count;
+}
+
+/**
+ * @brief CompactList::push_back
+ * @param t
+ * Add t to the back of the list
+ */
+void CompactList::push_back(Thing t)
+{
+    uint32_t i = new_node(t);
+    nodes[i].next = CompactNode::none;
+    if (tail == CompactNode::none){
+        head = i;
+    }
+    else{
+        nodes[tail].next = i;
+    }
+    tail = i;
+    ++count;
+}
+
+/**
+ * @brief CompactList::pop_back
+ * Remove the last item in the list. Never called on an empty list.
+ * Singly linked, so the new tail is found from the front.
+ */
+void CompactList::pop_back()
+{
+    if (head == tail){
+        free_node(head);
+        head = tail = CompactNode::none;
+    }
+    else{
+        uint32_t curr = head;
+        while (nodes[curr].next != tail){
+            curr = nodes[curr].next;
+        }
+        free_node(tail);
+        nodes[curr].next = CompactNode::none;
+        tail = curr;
+    }
+    --count;
+}
+
+/**
+ * @brief CompactList::size
+ * @return number of items in the list
+ */
+size_t CompactList::size()
+{
+    return count;
+}
+
+/**
+ * @brief CompactList::capacity
+ * @return number of nodes the array can hold before it grows
+ */
+size_t CompactList::capacity()
+{
+    return n_allocated;
+}
+
+/**
+ * @brief CompactList::used
+ * @return number of nodes at the start of data() that have been handed out,
+ * free ones included. Nodes past these are uninitialised.
+ */
+size_t CompactList::used()
+{
+    return n_used;
+}
+
+/**
+ * @brief CompactList::front
+ * @return a reference to the first item in the list
+ */
+Thing &CompactList::front()
+{
+    return nodes[head].value;
+}
+
+/**
+ * @brief CompactList::back
+ * @return a reference to the last item in the list
+ */
+Thing &CompactList::back()
+{
+    return nodes[tail].value;
+}
+
+/**
+ * @brief CompactList::at
+ * @param i
+ * @return A reference to the thing at index i
+ * @throws std::out_of_range("i out of bounds")
+ */
+Thing &CompactList::at(size_t i)
+{
+    if (i >= count){
+        throw std::out_of_range("i out of bounds");
+    }
+    uint32_t curr = head;
+    for (size_t j = 0; j < i; ++j){
+        curr = nodes[curr].next;
+    }
+    return nodes[curr].value;
+}
+
+/**
+ * @brief CompactList::begin
+ * @return an iterator referencing the first item
+ */
+CompactListIterator CompactList::begin()
+{
+    CompactListIterator iter;
+    iter.nodes = nodes;
+    iter.index = head;
+    return iter;
+}
+
+/**
+ * @brief CompactList::end
+ * @return an iterator representing one past the last item
+ */
+CompactListIterator CompactList::end()
+{
+    CompactListIterator iter;
+    iter.nodes = nodes;
+    return iter;
+}
+
+/**
+ * @brief CompactList::reverse
+ * Reverse the list by changing next indices only.
+ */
+void CompactList::reverse()
+{
+    uint32_t prev = CompactNode::none;
+    uint32_t curr = head;
+    tail = head;
+    while (curr != CompactNode::none){
+        uint32_t next = nodes[curr].next;
+        nodes[curr].next = prev;
+        prev = curr;
+        curr = next;
+    }
+    head = prev;
+}
+
+/**
+ * @brief CompactList::compact
+ * Rewrite the node array so that node i is the ith item of the list and
+ * drop the free list. Afterwards the array holds exactly size() nodes in
+ * order, so traversal is a sequential scan the hardware prefetcher can follow.
+ */
+void CompactList::compact()
+{
+    CompactNode *packed = nullptr;
+    if (count != 0){
+        packed = static_cast<CompactNode*>(std::malloc(count * sizeof(CompactNode)));
+        if (packed == nullptr){
+            throw std::bad_alloc();
+        }
+        uint32_t j = 0;
+        for (uint32_t curr = head; curr != CompactNode::none; curr = nodes[curr].next, ++j){
+            packed[j].value = nodes[curr].value;
+            packed[j].next = j + 1;
+        }
+        packed[j - 1].next = CompactNode::none;
+    }
+    std::free(nodes);
+    nodes = packed;
+    n_allocated = n_used = uint32_t(count);
+    free_head = CompactNode::none;
+    head = count == 0 ? CompactNode::none : 0;
+    tail = count == 0 ? CompactNode::none : n_used - 1;
+}
+
+/**
+ * @brief CompactList::data
+ * @return The node array. Only its first used() nodes are initialised;
+ * together with head_index() they are the whole list and can be saved or
+ * copied as one block.
+ */
+const CompactNode *CompactList::data()
+{
+    return nodes;
+}
+
+/**
+ * @brief CompactList::head_index
+ * @return The index of the first node, CompactNode::none if the list is empty
+ */
+uint32_t CompactList::head_index()
+{
+    return head;
+}
+
+/**
+ * Take a node from the free list, or the next unused slot, growing the array if needed.
+ */
+uint32_t CompactList::new_node(Thing t)
+{
+    uint32_t i;
+    if (free_head != CompactNode::none){
+        i = free_head;
+        free_head = nodes[i].next;
+    }
+    else{
+        if (n_used == n_allocated){
+            grow();
+        }
+        i = n_used++;
+    }
+    nodes[i].value = t;
+    return i;
+}
+
+/**
+ * Put node i on the free list.
+ */
+void CompactList::free_node(uint32_t i)
+{
+    nodes[i].next = free_head;
+    free_head = i;
+}
+
+/**
+ * Double the node array. Nodes are plain data and links are indices,
+ * so realloc may move the block without fixing anything up.
+ */
+void CompactList::grow()
+{
+    uint32_t new_size = n_allocated == 0 ? 16 : n_allocated * 2;
+    if (new_size <= n_allocated || new_size == CompactNode::none){
+        throw std::length_error("CompactList is full");
+    }
+    void *grown = std::realloc(nodes, new_size * sizeof(CompactNode));
+    if (grown == nullptr){
+        throw std::bad_alloc();
+    }
+    nodes = static_cast<CompactNode*>(grown);
+    n_allocated = new_size;
+}
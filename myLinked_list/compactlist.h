@@ -0,0 +1,83 @@
+#ifndef COMPACTLIST_H
+#define COMPACTLIST_H
+
+#include <cstdint>
+#include "linkedlist.h"
+
+// Node of a CompactList. Links are 32 bit indices into the list's node
+//   array instead of pointers, so a node holding a Thing is 8 bytes.
+struct CompactNode{
+   static const uint32_t none = 0xFFFFFFFFu; // Index meaning "no node"
+
+   Thing value;
+   uint32_t next;
+};
+
+
+// Iterator for CompactList
+class CompactListIterator{
+public:
+   CompactNode *nodes = nullptr;       // Node array of the list
+   uint32_t index = CompactNode::none; // Current node
+
+   Thing& operator*();                // Dereference
+   CompactListIterator& operator++(); // Increment
+
+   bool operator !=(const CompactListIterator& other) const{
+       return index != other.index;
+   }
+};
+
+
+// Singly linked list whose nodes all live in one growable array.
+//   Removed nodes go onto a free list threaded through the same next
+//   indices and are reused by the next insert. Because links are indices
+//   the node array can be moved, copied or written out as one block, and
+//   compact() relays it out in list order so a walk is a linear scan.
+//   Growing the array invalidates references and iterators.
+class CompactList{
+public:
+   CompactList();
+   ~CompactList();
+
+   CompactList(const CompactList&) = delete;
+   CompactList& operator=(const CompactList&) = delete;
+
+   void push_front(Thing t);
+   void pop_front();
+
+   void push_back(Thing t);
+   void pop_back();
+
+   size_t size();
+   size_t capacity();
+   size_t used();
+
+   Thing& front();
+   Thing& back();
+   Thing& at(size_t i);
+
+   CompactListIterator begin();
+   CompactListIterator end();
+
+   void reverse();
+   void compact();
+
+   const CompactNode* data();
+   uint32_t head_index();
+
+private:
+   uint32_t new_node(Thing t);
+   void free_node(uint32_t i);
+   void grow();
+
+   CompactNode *nodes = nullptr;
+   uint32_t n_allocated = 0;          // Length of nodes
+   uint32_t n_used = 0;               // Nodes ever handed out, free ones included
+   uint32_t head = CompactNode::none;
+   uint32_t tail = CompactNode::none;
+   uint32_t free_head = CompactNode::none;
+   size_t count = 0;
+};
+
+#endif // COMPACTLIST_H
@@ -0,0 +1,209 @@
+#include "conslist.h"
+#include "slabpool.h"
+
+#include <utility>
+
+/**
+ * @brief ConsNode::operator new
+ * Nodes come from the SlabPool, like Links in production.
+ */
+void *ConsNode::operator new(size_t sz)
+{
+    return SlabPool::for_size(sz).allocate();
+}
+
+void ConsNode::operator delete(void *ptr)
+{
+    SlabPool::free(ptr);
+}
+
+/**
+ * @brief ConsListIterator::operator*
+ * @return Return a reference to the thing in the node that we're pointing to
+ */
+const Thing &ConsListIterator::operator*() const
+{
+    return ptr->value;
+}
+
+/**
+ * @brief ConsListIterator::operator++
+ * Make the current iterator point to the next node in the list.
+ * @return Return a reference to this object.
+ */
+ConsListIterator &ConsListIterator::operator++()
+{
+    ptr = ptr->next;
+    return *this;
+}
+
+/**
+ * @brief ConsList::ConsList
+ * Construct the empty list.
+ */
+ConsList::ConsList()
+{
+}
+
+/**
+ * @brief ConsList::ConsList
+ * @param other
+ * Snapshot other in O(1): both share every node.
+ */
+ConsList::ConsList(const ConsList &other) : head(other.head)
+{
+    retain(head);
+}
+
+/**
+ * @brief ConsList::ConsList
+ * @param other Left empty
+ */
+ConsList::ConsList(ConsList &&other) : head(other.head)
+{
+    other.head = nullptr;
+}
+
+/**
+ * @brief ConsList::operator =
+ * @param other A copy of the list to assign, taken by value
+ * @return This list, now sharing other's nodes
+ */
+ConsList &ConsList::operator=(ConsList other)
+{
+    std::swap(head, other.head);
+    return *this;
+}
+
+/**
+ * @brief ConsList::~ConsList
+ * Drop this version. Nodes no other version uses are freed.
+ */
+ConsList::~ConsList()
+{
+    release(head);
+}
+
+/**
+ * @brief ConsList::push_front
+ * @param t
+ * @return A new version with t in front of this one's items. O(1).
+ */
+ConsList ConsList::push_front(Thing t) const
+{
+    retain(head);
+    return ConsList(new ConsNode(t, head));
+}
+
+/**
+ * @brief ConsList::pop_front
+ * @return A new version without the front item. O(1). Never called on an empty list.
+ */
+ConsList ConsList::pop_front() const
+{
+    retain(head->next);
+    return ConsList(head->next);
+}
+
+/**
+ * @brief ConsList::front
+ * @return a reference to the first item in the list
+ */
+const Thing &ConsList::front() const
+{
+    return head->value;
+}
+
+/**
+ * @brief ConsList::size
+ * @return number of items in the list. O(1), every node knows its length.
+ */
+size_t ConsList::size() const
+{
+    return head == nullptr ? 0 : head->length;
+}
+
+/**
+ * @brief ConsList::empty
+ * @return true if there are no items in the list
+ */
+bool ConsList::empty() const
+{
+    return head == nullptr;
+}
+
+/**
+ * @brief ConsList::begin
+ * @return an iterator referencing the first item
+ */
+ConsListIterator ConsList::begin() const
+{
+    ConsListIterator iter;
+    iter.ptr = head;
+    return iter;
+}
+
+/**
+ * @brief ConsList::end
+ * @return an iterator representing one past the last item
+ */
+ConsListIterator ConsList::end() const
+{
+    return ConsListIterator();
+}
+
+/**
+ * @brief ConsList::shares_nodes_with
+ * @param other
+ * @return true if both versions still hold at least one node in common,
+ * compared by address, so equal items in separate nodes do not count.
+ * Nodes are immutable, so the nodes two versions share are always a common
+ * tail of both chains and sit at the same length from the end: the longer
+ * chain is skipped down to the shorter one's length, then both are walked
+ * in step. O(size() + other.size()), not O(1).
+ */
+bool ConsList::shares_nodes_with(const ConsList &other) const
+{
+    const ConsNode *a = head;
+    const ConsNode *b = other.head;
+    while (a != nullptr && b != nullptr && a->length != b->length){
+        if (a->length > b->length){
+            a = a->next;
+        }
+        else{
+            b = b->next;
+        }
+    }
+    while (a != nullptr && b != nullptr && a != b){
+        a = a->next;
+        b = b->next;
+    }
+    return a != nullptr && a == b;
+}
+
+/**
+ * Adopt a node whose reference has already been counted.
+ */
+ConsList::ConsList(ConsNode *head) : head(head)
+{
+}
+
+void ConsList::retain(ConsNode *node)
+{
+    if (node != nullptr){
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Drop one reference to node. Each node freed drops its reference to the
+ * next one, which is done in this loop instead of recursively.
+ */
+void ConsList::release(ConsNode *node)
+{
+    while (node != nullptr && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        ConsNode *next = node->next;
+        delete node;
+        node = next;
+    }
+}
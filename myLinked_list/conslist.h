@@ -0,0 +1,75 @@
+#ifndef CONSLIST_H
+#define CONSLIST_H
+
+#include <atomic>
+#include "linkedlist.h"
+
+// Node of a ConsList. Immutable once built; refs counts the lists and
+//   nodes pointing at it. Allocated from the SlabPool.
+struct ConsNode{
+   Thing value;
+   size_t length;                 // Items from this node to the end
+   ConsNode *next;
+   std::atomic<size_t> refs;
+
+   ConsNode(Thing v, ConsNode* next)
+       : value(v), length(next == nullptr ? 1 : next->length + 1), next(next), refs(1){}
+
+   void* operator new(size_t sz);
+   void operator delete(void* ptr);
+};
+
+
+// Iterator for ConsList, read only
+class ConsListIterator{
+public:
+   const ConsNode *ptr = nullptr; // Points to the current node
+
+   const Thing& operator*() const;  // Dereference
+   ConsListIterator& operator++();  // Increment
+
+   bool operator !=(const ConsListIterator& other) const{
+       return ptr != other.ptr;
+   }
+};
+
+
+// Persistent singly linked list. A ConsList is a handle on an immutable
+//   chain of nodes; push_front and pop_front return a new version that
+//   shares the rest of the chain, and copying a handle is an O(1) snapshot.
+//   Nodes are reference counted (atomically, so versions may be handed to
+//   other threads) and freed when the last version using them goes away.
+//   Freeing walks the chain in a loop, so long lists do not recurse.
+//
+//   A single ConsList object is not safe to assign from several threads at
+//   once, but any number of threads may hold their own copies.
+class ConsList{
+public:
+   ConsList();
+   ConsList(const ConsList& other);
+   ConsList(ConsList&& other);
+   ConsList& operator=(ConsList other);
+   ~ConsList();
+
+   ConsList push_front(Thing t) const;
+   ConsList pop_front() const;
+
+   const Thing& front() const;
+   size_t size() const;
+   bool empty() const;
+
+   ConsListIterator begin() const;
+   ConsListIterator end() const;
+
+   bool shares_nodes_with(const ConsList& other) const;  // Walks both chains
+
+private:
+   explicit ConsList(ConsNode* head);
+
+   static void retain(ConsNode* node);
+   static void release(ConsNode* node);
+
+   ConsNode *head = nullptr;
+};
+
+#endif // CONSLIST_H
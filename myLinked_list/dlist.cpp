@@ -0,0 +1,218 @@
+#include "dlist.h"
+
+/**
+ * @brief DListIterator::operator++
+ * Make the current iterator point to the next link in the list.
+ * @return Return a reference to this object.
+ */
+DListIterator &DListIterator::operator++()
+{
+    ptr = ptr->next;
+    return *this;
+}
+
+/**
+ * @brief DListIterator::operator--
+ * Make the current iterator point to the previous link in the list.
+ * Decrementing end() gives the last link.
+ * @return Return a reference to this object.
+ */
+DListIterator &DListIterator::operator--()
+{
+    ptr = static_cast<DLink*>(ptr)->prev;
+    return *this;
+}
+
+/**
+ * @brief DList::DList
+ * An empty list is the sentinel pointing at itself.
+ */
+DList::DList()
+{
+    sentinel.next = &sentinel;
+    sentinel.prev = &sentinel;
+}
+
+/**
+ * @brief DList::~DList
+ * Free every link in a single pass from the front.
+ */
+DList::~DList()
+{
+    Link *curr = sentinel.next;
+    while (curr != &sentinel){
+        Link *next = curr->next;
+        delete static_cast<DLink*>(curr);
+        curr = next;
+    }
+}
+
+/**
+ * @brief DList::push_front
+ * @param t
+ * Push t to the front of the list
+ */
+void DList::push_front(Thing t)
+{
+    link_before(static_cast<DLink*>(sentinel.next), new DLink(t));
+}
+
+/**
+ * @brief DList::pop_front
+ * Remove the front item in the list. Never called on an empty list.
+ */
+void DList::pop_front()
+{
+    DLink *first = static_cast<DLink*>(sentinel.next);
+    unlink(first);
+    delete first;
+}
+
+/**
+ * @brief DList::push_back
+ * @param t
+ * Add t to the back of the list
+ */
+void DList::push_back(Thing t)
+{
+    link_before(&sentinel, new DLink(t));
+}
+
+/**
+ * @brief DList::pop_back
+ * Remove the last link in the list. Never called on an empty list.
+ */
+void DList::pop_back()
+{
+    DLink *last = sentinel.prev;
+    unlink(last);
+    delete last;
+}
+
+/**
+ * @brief DList::size
+ * @return number of items in the list
+ */
+size_t DList::size()
+{
+    return count;
+}
+
+/**
+ * @brief DList::empty
+ * @return true if there are no items in the list
+ */
+bool DList::empty()
+{
+    return count == 0;
+}
+
+/**
+ * @brief DList::front
+ * @return a reference to the first item in the list
+ */
+Thing &DList::front()
+{
+    return sentinel.next->value;
+}
+
+/**
+ * @brief DList::back
+ * @return a reference to the last item in the list
+ */
+Thing &DList::back()
+{
+    return sentinel.prev->value;
+}
+
+/**
+ * @brief DList::begin
+ * @return a DListIterator referencing the first item
+ */
+DListIterator DList::begin()
+{
+    DListIterator iter;
+    iter.ptr = sentinel.next;
+    return iter;
+}
+
+/**
+ * @brief DList::end
+ * @return a DListIterator representing one past the last item, which is the sentinel
+ */
+DListIterator DList::end()
+{
+    DListIterator last;
+    last.ptr = &sentinel;
+    return last;
+}
+
+/**
+ * @brief DList::insert
+ * @param pos
+ * @param t
+ * @return An iterator to the new link, which is placed before pos
+ */
+DListIterator DList::insert(DListIterator pos, Thing t)
+{
+    DLink *link = new DLink(t);
+    link_before(static_cast<DLink*>(pos.ptr), link);
+    DListIterator iter;
+    iter.ptr = link;
+    return iter;
+}
+
+/**
+ * @brief DList::erase
+ * @param pos An iterator to a link in this list, not end()
+ * @return An iterator to the link after the erased one
+ */
+DListIterator DList::erase(DListIterator pos)
+{
+    DLink *link = static_cast<DLink*>(pos.ptr);
+    DListIterator next;
+    next.ptr = link->next;
+    unlink(link);
+    delete link;
+    return next;
+}
+
+/**
+ * @brief DList::reverse
+ * Reverse the list by swapping the next and prev pointers of every link,
+ * including the sentinel.
+ */
+void DList::reverse()
+{
+    DLink *curr = &sentinel;
+    do{
+        DLink *next = static_cast<DLink*>(curr->next);
+        curr->next = curr->prev;
+        curr->prev = next;
+        curr = next;
+    } while (curr != &sentinel);
+}
+
+/**
+ * Splice link into the list just before pos.
+ */
+void DList::link_before(DLink *pos, DLink *link)
+{
+    DLink *before = pos->prev;
+    link->prev = before;
+    link->next = pos;
+    before->next = link;
+    pos->prev = link;
+    ++count;
+}
+
+/**
+ * Take link out of the list without freeing it.
+ */
+void DList::unlink(DLink *link)
+{
+    DLink *after = static_cast<DLink*>(link->next);
+    link->prev->next = after;
+    after->prev = link->prev;
+    --count;
+}
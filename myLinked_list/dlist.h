@@ -0,0 +1,72 @@
+#ifndef DLIST_H
+#define DLIST_H
+
+#include "linkedlist.h"
+
+// Link that also points back to the previous link.
+class DLink : public Link{
+public:
+   DLink *prev = nullptr; // Previous pointer, defaults to nullptr
+
+   DLink(){}                           // Default Constructor
+   DLink(Thing v) : Link(v){}          // Build a new DLink from v
+
+   // Link's operator new/delete are written for sizeof(Link), so DLink
+   //   goes back to the global ones.
+   void* operator new(size_t sz){ return ::operator new(sz); }
+   void operator delete(void* ptr){ ::operator delete(ptr); }
+};
+
+
+// Bidirectional iterator for DList. ptr always points at a DLink.
+class DListIterator : public LinkedListIterator{
+public:
+   DListIterator& operator++(); // Increment
+   DListIterator& operator--(); // Decrement
+
+   bool operator ==(const DListIterator& other) const{
+       return ptr == other.ptr;
+   }
+};
+
+
+// Doubly linked list with a sentinel link. The sentinel sits between the
+//   last and the first link, so there are no nullptr special cases and
+//   every insert or erase is O(1).
+class DList{
+public:
+   DList();
+   ~DList();
+
+   DList(const DList&) = delete;
+   DList& operator=(const DList&) = delete;
+
+   void push_front(Thing t);
+   void pop_front();
+
+   void push_back(Thing t);
+   void pop_back();
+
+   size_t size();
+   bool empty();
+
+   Thing& front();
+   Thing& back();
+
+   DListIterator begin();
+   DListIterator end();
+
+   DListIterator insert(DListIterator pos, Thing t);
+   DListIterator erase(DListIterator pos);
+
+   void reverse();
+
+private:
+   void link_before(DLink *pos, DLink *link);
+   void unlink(DLink *link);
+
+   DLink sentinel;  // next is the first link, prev is the last link
+   size_t count = 0;
+};
+
+#endif // DLIST_H
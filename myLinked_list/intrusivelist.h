@@ -0,0 +1,310 @@
+#ifndef INTRUSIVELIST_H
+#define INTRUSIVELIST_H
+
+#include <cstddef>
+#include <type_traits>
+
+// Links embedded inside an object so that it can be put on an
+//   IntrusiveList without allocating anything. One hook per list the
+//   object may be on at the same time. Copying an object does not copy
+//   its list membership.
+class IntrusiveHook{
+public:
+   IntrusiveHook *next = nullptr;  // nullptr while not on a list
+   IntrusiveHook *prev = nullptr;
+
+   IntrusiveHook(){}
+   IntrusiveHook(const IntrusiveHook&){}
+   IntrusiveHook& operator=(const IntrusiveHook&){ return *this; }
+
+   bool is_linked() const{ return next != nullptr; }
+};
+
+// Hook inherited as a base class. Tag tells several base hooks apart.
+template<class Tag = void>
+class IntrusiveBaseHook : public IntrusiveHook{};
+
+
+// Hook accessors for objects deriving from IntrusiveBaseHook<Tag>.
+template<class T, class Tag = void>
+struct BaseHook{
+   static IntrusiveHook* to_hook(T* obj){
+       return static_cast<IntrusiveBaseHook<Tag>*>(obj);
+   }
+   static T* to_object(IntrusiveHook* hook){
+       return static_cast<T*>(static_cast<IntrusiveBaseHook<Tag>*>(hook));
+   }
+};
+
+// Hook accessors for objects holding an IntrusiveHook data member.
+template<class T, IntrusiveHook T::*Member>
+struct MemberHook{
+   static IntrusiveHook* to_hook(T* obj){
+       return &(obj->*Member);
+   }
+   static T* to_object(IntrusiveHook* hook){
+       return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - offset());
+   }
+   static std::ptrdiff_t offset(){
+       // Never constructed, only used to measure where the member sits.
+       static typename std::aligned_storage<sizeof(T), alignof(T)>::type probe;
+       T* obj = reinterpret_cast<T*>(&probe);
+       return reinterpret_cast<char*>(&(obj->*Member)) - reinterpret_cast<char*>(obj);
+   }
+};
+
+
+// Doubly linked list of objects that live somewhere else.
+//   The list never allocates, copies or frees an object; it only rewires
+//   the hooks selected by Hook (BaseHook or MemberHook). Push, pop and
+//   remove are O(1). An object must be taken off a list before it is destroyed.
+template<class T, class Hook = BaseHook<T>>
+class IntrusiveList{
+public:
+   // Bidirectional iterator over the objects in the list.
+   class Iterator{
+   public:
+      IntrusiveHook *ptr = nullptr; // Points to the current hook.
+
+      T& operator*(){ return *Hook::to_object(ptr); }
+      T* operator->(){ return Hook::to_object(ptr); }
+      Iterator& operator++(){ ptr = ptr->next; return *this; }
+      Iterator& operator--(){ ptr = ptr->prev; return *this; }
+
+      bool operator !=(const Iterator& other) const{ return ptr != other.ptr; }
+      bool operator ==(const Iterator& other) const{ return ptr == other.ptr; }
+   };
+
+   IntrusiveList();
+   ~IntrusiveList();
+
+   IntrusiveList(const IntrusiveList&) = delete;
+   IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+   void push_front(T& obj);
+   void pop_front();
+
+   void push_back(T& obj);
+   void pop_back();
+
+   size_t size() const;
+   bool empty() const;
+
+   T& front();
+   T& back();
+
+   Iterator begin();
+   Iterator end();
+
+   void remove(T& obj);
+   void reverse();
+   void clear();
+
+private:
+   void link_before(IntrusiveHook *pos, IntrusiveHook *hook);
+   void unlink(IntrusiveHook *hook);
+
+   IntrusiveHook sentinel;  // next is the first hook, prev is the last hook
+   size_t count = 0;
+};
+
+/**
+ * @brief IntrusiveList::IntrusiveList
+ * An empty list is the sentinel pointing at itself.
+ */
+template<class T, class Hook>
+IntrusiveList<T, Hook>::IntrusiveList()
+{
+    sentinel.next = &sentinel;
+    sentinel.prev = &sentinel;
+}
+
+/**
+ * @brief IntrusiveList::~IntrusiveList
+ * Take every object off the list. The objects themselves are untouched.
+ */
+template<class T, class Hook>
+IntrusiveList<T, Hook>::~IntrusiveList()
+{
+    clear();
+}
+
+/**
+ * @brief IntrusiveList::push_front
+ * @param obj An object that is not on a list through this hook yet
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::push_front(T &obj)
+{
+    link_before(sentinel.next, Hook::to_hook(&obj));
+}
+
+/**
+ * @brief IntrusiveList::pop_front
+ * Take the front object off the list. Never called on an empty list.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::pop_front()
+{
+    unlink(sentinel.next);
+}
+
+/**
+ * @brief IntrusiveList::push_back
+ * @param obj An object that is not on a list through this hook yet
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::push_back(T &obj)
+{
+    link_before(&sentinel, Hook::to_hook(&obj));
+}
+
+/**
+ * @brief IntrusiveList::pop_back
+ * Take the last object off the list. Never called on an empty list.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::pop_back()
+{
+    unlink(sentinel.prev);
+}
+
+/**
+ * @brief IntrusiveList::size
+ * @return number of objects on the list
+ */
+template<class T, class Hook>
+size_t IntrusiveList<T, Hook>::size() const
+{
+    return count;
+}
+
+/**
+ * @brief IntrusiveList::empty
+ * @return true if there are no objects on the list
+ */
+template<class T, class Hook>
+bool IntrusiveList<T, Hook>::empty() const
+{
+    return count == 0;
+}
+
+/**
+ * @brief IntrusiveList::front
+ * @return a reference to the first object
+ */
+template<class T, class Hook>
+T &IntrusiveList<T, Hook>::front()
+{
+    return *Hook::to_object(sentinel.next);
+}
+
+/**
+ * @brief IntrusiveList::back
+ * @return a reference to the last object
+ */
+template<class T, class Hook>
+T &IntrusiveList<T, Hook>::back()
+{
+    return *Hook::to_object(sentinel.prev);
+}
+
+/**
+ * @brief IntrusiveList::begin
+ * @return an iterator referencing the first object
+ */
+template<class T, class Hook>
+typename IntrusiveList<T, Hook>::Iterator IntrusiveList<T, Hook>::begin()
+{
+    Iterator iter;
+    iter.ptr = sentinel.next;
+    return iter;
+}
+
+/**
+ * @brief IntrusiveList::end
+ * @return an iterator representing one past the last object, which is the sentinel
+ */
+template<class T, class Hook>
+typename IntrusiveList<T, Hook>::Iterator IntrusiveList<T, Hook>::end()
+{
+    Iterator iter;
+    iter.ptr = &sentinel;
+    return iter;
+}
+
+/**
+ * @brief IntrusiveList::remove
+ * @param obj An object on this list
+ * Take obj off the list in O(1).
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::remove(T &obj)
+{
+    unlink(Hook::to_hook(&obj));
+}
+
+/**
+ * @brief IntrusiveList::reverse
+ * Reverse the list by swapping the next and prev pointers of every hook,
+ * including the sentinel.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::reverse()
+{
+    IntrusiveHook *curr = &sentinel;
+    do{
+        IntrusiveHook *next = curr->next;
+        curr->next = curr->prev;
+        curr->prev = next;
+        curr = next;
+    } while (curr != &sentinel);
+}
+
+/**
+ * @brief IntrusiveList::clear
+ * Take every object off the list.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::clear()
+{
+    IntrusiveHook *curr = sentinel.next;
+    while (curr != &sentinel){
+        IntrusiveHook *next = curr->next;
+        curr->next = nullptr;
+        curr->prev = nullptr;
+        curr = next;
+    }
+    sentinel.next = &sentinel;
+    sentinel.prev = &sentinel;
+    count = 0;
+}
+
+/**
+ * Splice hook into the list just before pos.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::link_before(IntrusiveHook *pos, IntrusiveHook *hook)
+{
+    IntrusiveHook *before = pos->prev;
+    hook->prev = before;
+    hook->next = pos;
+    before->next = hook;
+    pos->prev = hook;
+    ++count;
+}
+
+/**
+ * Take hook out of the list and mark it as not linked.
+ */
+template<class T, class Hook>
+void IntrusiveList<T, Hook>::unlink(IntrusiveHook *hook)
+{
+    hook->prev->next = hook->next;
+    hook->next->prev = hook->prev;
+    hook->next = nullptr;
+    hook->prev = nullptr;
+    --count;
+}
+
+#endif // INTRUSIVELIST_H
@@ -0,0 +1,168 @@
+#include "lazylist.h"
+
+#include <climits>
+#include <stdexcept>
+
+/**
+ * @brief LazyList::LazyList
+ * Construct an empty set: just the two sentinels.
+ */
+LazyList::LazyList() : head(new LazyNode(Thing(INT_MIN), new LazyNode(Thing(INT_MAX), nullptr)))
+{
+}
+
+/**
+ * @brief LazyList::~LazyList
+ * Delete every node still linked. Retired nodes go with the domain.
+ * No other thread may be using the list.
+ */
+LazyList::~LazyList()
+{
+    LazyNode *curr = head;
+    while (curr != nullptr){
+        LazyNode *next = curr->next.load(std::memory_order_relaxed);
+        delete curr;
+        curr = next;
+    }
+}
+
+/**
+ * @brief LazyList::insert
+ * @param t
+ * @return true if t was added, false if an equal item was already there
+ * @throws std::invalid_argument if t.i is INT_MIN or INT_MAX
+ */
+bool LazyList::insert(Thing t)
+{
+    check_key(t.i);
+    EpochDomain::Guard guard(epochs);
+    for (;;){
+        LazyNode *pred, *curr;
+        locate(t.i, pred, curr);
+        std::lock_guard<std::mutex> pred_lock(pred->lock);
+        std::lock_guard<std::mutex> curr_lock(curr->lock);
+        if (!validate(pred, curr)){
+            continue;
+        }
+        if (curr->value.i == t.i){
+            return false;
+        }
+        pred->next.store(new LazyNode(t, curr), std::memory_order_release);
+        return true;
+    }
+}
+
+/**
+ * @brief LazyList::erase
+ * @param t
+ * @return true if an item equal to t was found and removed
+ * @throws std::invalid_argument if t.i is INT_MIN or INT_MAX
+ */
+bool LazyList::erase(Thing t)
+{
+    check_key(t.i);
+    EpochDomain::Guard guard(epochs);
+    for (;;){
+        LazyNode *pred, *curr;
+        locate(t.i, pred, curr);
+        {
+            std::lock_guard<std::mutex> pred_lock(pred->lock);
+            std::lock_guard<std::mutex> curr_lock(curr->lock);
+            if (!validate(pred, curr)){
+                continue;
+            }
+            if (curr->value.i != t.i){
+                return false;
+            }
+            curr->marked.store(true, std::memory_order_release);
+            pred->next.store(curr->next.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+        epochs.retire(curr);
+        return true;
+    }
+}
+
+/**
+ * @brief LazyList::contains
+ * @param t
+ * @return true if an item equal to t is in the set. Wait-free once the
+ * thread holds an epoch record; the thread's first call on the list claims
+ * one under a lock.
+ * Always false for INT_MIN and INT_MAX, which can never be inserted.
+ */
+bool LazyList::contains(Thing t)
+{
+    if (t.i == INT_MIN || t.i == INT_MAX){
+        return false;
+    }
+    EpochDomain::Guard guard(epochs);
+    LazyNode *curr = head;
+    while (curr->value.i < t.i){
+        curr = curr->next.load(std::memory_order_acquire);
+    }
+    return curr->value.i == t.i && !curr->marked.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief LazyList::check_key
+ * @param key
+ * @throws std::invalid_argument if key is one of the sentinels' keys
+ */
+void LazyList::check_key(int key)
+{
+    if (key == INT_MIN || key == INT_MAX){
+        throw std::invalid_argument("LazyList keys must lie strictly between INT_MIN and INT_MAX");
+    }
+}
+
+/**
+ * @brief LazyList::size_approx
+ * @return The number of unmarked items seen in one pass. Not a snapshot
+ * while other threads are updating the set.
+ */
+size_t LazyList::size_approx()
+{
+    EpochDomain::Guard guard(epochs);
+    size_t n = 0;
+    for (LazyNode *curr = head->next.load(std::memory_order_acquire);
+         curr->next.load(std::memory_order_acquire) != nullptr;
+         curr = curr->next.load(std::memory_order_acquire)){
+        if (!curr->marked.load(std::memory_order_relaxed)){
+            ++n;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief LazyList::domain
+ * @return The domain removed nodes are retired to, e.g. to collect() it
+ */
+EpochDomain &LazyList::domain()
+{
+    return epochs;
+}
+
+/**
+ * Walk without locks to the first node with a value >= key (curr)
+ * and the node before it (pred).
+ */
+void LazyList::locate(int key, LazyNode *&pred, LazyNode *&curr)
+{
+    pred = head;
+    curr = head->next.load(std::memory_order_acquire);
+    while (curr->value.i < key){
+        pred = curr;
+        curr = curr->next.load(std::memory_order_acquire);
+    }
+}
+
+/**
+ * With both locked: true if neither node is removed and pred still points at curr.
+ */
+bool LazyList::validate(LazyNode *pred, LazyNode *curr)
+{
+    return !pred->marked.load(std::memory_order_relaxed) &&
+           !curr->marked.load(std::memory_order_relaxed) &&
+           pred->next.load(std::memory_order_relaxed) == curr;
+}
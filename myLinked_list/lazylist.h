@@ -0,0 +1,64 @@
+#ifndef LAZYLIST_H
+#define LAZYLIST_H
+
+#include <atomic>
+#include <mutex>
+#include "linkedlist.h"
+#include "reclaim.h"
+
+// Node of a LazyList. value never changes after the node is published.
+struct LazyNode{
+   Thing value;
+   std::atomic<LazyNode*> next;
+   std::atomic<bool> marked;   // Logically removed, next may no longer be followed to the set
+   std::mutex lock;
+
+   LazyNode(Thing v, LazyNode* next) : value(v), next(next), marked(false){}
+};
+
+
+// Sorted set of Things (by Thing::i) for many readers and a few writers,
+//   using lazy synchronization (Heller et al.).
+//
+//   insert and erase walk the list without locks, then lock only the two
+//   nodes around the key and check that neither is marked and that they
+//   are still adjacent, starting over if not. erase marks a node before
+//   unlinking it, so a reader that lands on it can tell it is gone.
+//
+//   contains takes no locks and never retries: one pass from head, then a
+//   look at the mark. It is wait-free once the calling thread holds a
+//   record in the list's EpochDomain. A thread's first operation on the
+//   list claims that record under the domain's lock, and may allocate.
+//
+//   Unlinked nodes are retired to the list's EpochDomain; every operation
+//   runs inside a guard. Keys must lie strictly between INT_MIN and INT_MAX,
+//   which the sentinels use; insert and erase throw std::invalid_argument
+//   for them.
+//
+//   Allocate with automatic or static storage: C++11 operator new does
+//   not honour the over-alignment of the domain.
+class LazyList{
+public:
+   LazyList();
+   ~LazyList();
+
+   LazyList(const LazyList&) = delete;
+   LazyList& operator=(const LazyList&) = delete;
+
+   bool insert(Thing t);
+   bool erase(Thing t);
+   bool contains(Thing t);
+
+   size_t size_approx();
+   EpochDomain& domain();
+
+private:
+   void locate(int key, LazyNode*& pred, LazyNode*& curr);
+   static bool validate(LazyNode* pred, LazyNode* curr);
+   static void check_key(int key);
+
+   EpochDomain epochs;
+   LazyNode *head;   // Sentinel with INT_MIN, always first
+};
+
+#endif // LAZYLIST_H
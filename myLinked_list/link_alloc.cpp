@@ -0,0 +1,18 @@
+#include "linkedlist.h"
+#include "slabpool.h"
+
+// Link::operator new/delete and Link::allocate_n for programs that use
+//   the list. The tests replace these with their own tracking versions,
+//   so this file is only linked into other programs.
+
+void* Link::operator new(size_t sz){
+    return SlabPool::for_size(sz).allocate();
+}
+
+void Link::operator delete(void* ptr){
+    SlabPool::free(ptr);
+}
+
+void Link::allocate_n(Link** out, size_t k){
+    SlabPool::for_size(sizeof(Link)).allocate_n(reinterpret_cast<void**>(out), k);
+}
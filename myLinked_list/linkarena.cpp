@@ -0,0 +1,91 @@
+#include "linkarena.h"
+
+#include <cstdint>
+#include <new>
+
+/**
+ * @brief LinkArena::LinkArena
+ * Blocks are only allocated once something is allocated.
+ */
+LinkArena::LinkArena()
+{
+}
+
+/**
+ * @brief LinkArena::~LinkArena
+ * Free every block.
+ */
+LinkArena::~LinkArena()
+{
+    while (blocks != nullptr){
+        Block *next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+}
+
+/**
+ * @brief LinkArena::allocate
+ * @param sz Bytes wanted
+ * @param align A power of two no larger than alignof(std::max_align_t)
+ * @return Uninitialised memory that stays valid until reset() or the arena is destroyed
+ */
+void *LinkArena::allocate(size_t sz, size_t align)
+{
+    std::uintptr_t at = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~std::uintptr_t(align - 1);
+    if (cursor == nullptr || at + sz > reinterpret_cast<std::uintptr_t>(limit)){
+        add_block(sz + align);
+        at = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~std::uintptr_t(align - 1);
+    }
+    cursor = reinterpret_cast<char*>(at + sz);
+    return reinterpret_cast<void*>(at);
+}
+
+/**
+ * @brief LinkArena::reset
+ * Release everything allocated so far in O(number of blocks).
+ * The current block is kept so that a reused arena does not allocate again.
+ */
+void LinkArena::reset()
+{
+    if (blocks == nullptr){
+        return;
+    }
+    Block *old = blocks->next;
+    while (old != nullptr){
+        Block *next = old->next;
+        ::operator delete(old);
+        old = next;
+    }
+    blocks->next = nullptr;
+    cursor = reinterpret_cast<char*>(blocks + 1);
+    limit = cursor + blocks->size;
+}
+
+/**
+ * @brief LinkArena::block_count
+ * @return The number of blocks currently held
+ */
+size_t LinkArena::block_count()
+{
+    size_t n = 0;
+    for (Block *b = blocks; b != nullptr; b = b->next){
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * Start a new block with room for at least min_size bytes.
+ * Oversized requests get a block of their own size.
+ */
+void LinkArena::add_block(size_t min_size)
+{
+    size_t size = min_size > block_size ? min_size : block_size;
+    Block *block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = blocks;
+    block->size = size;
+    blocks = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    limit = cursor + size;
+}
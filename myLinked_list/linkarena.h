@@ -0,0 +1,38 @@
+#ifndef LINKARENA_H
+#define LINKARENA_H
+
+#include <cstddef>
+
+// Bump allocator for lists that all die at the same time.
+//   Memory comes from 64 KB blocks and is only given back all at once, by
+//   reset() or the destructor. Anything allocated from the arena must not
+//   be used after either of those.
+class LinkArena{
+public:
+   static const size_t block_size = 64 * 1024;
+
+   LinkArena();
+   ~LinkArena();
+
+   LinkArena(const LinkArena&) = delete;
+   LinkArena& operator=(const LinkArena&) = delete;
+
+   void* allocate(size_t sz, size_t align = alignof(std::max_align_t));
+   void reset();
+
+   size_t block_count();
+
+private:
+   struct Block{
+      Block *next;   // Previously filled block
+      size_t size;   // Usable bytes after the header
+   };
+
+   void add_block(size_t min_size);
+
+   Block *blocks = nullptr;  // Current block, older ones follow next
+   char *cursor = nullptr;   // Next free byte in the current block
+   char *limit = nullptr;    // End of the current block
+};
+
+#endif // LINKARENA_H
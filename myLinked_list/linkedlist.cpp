@@ -1,4 +1,11 @@
 #include "linkedlist.h"
+#include "linkarena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
 
 /**
  * @brief LinkedListIterator::operator*
@@ -20,6 +27,26 @@ LinkedListIterator &LinkedListIterator::operator++()
     return *this;
 }
 
+/**
+ * @brief LinkedListConstIterator::operator*
+ * @return Return a const reference to the thing in the link that we're pointing to
+ */
+const Thing &LinkedListConstIterator::operator*()
+{
+    return ptr->value;
+}
+
+/**
+ * @brief LinkedListConstIterator::operator++
+ * Make the current iterator point to the next link in the list.
+ * @return Return a reference to this object.
+ */
+LinkedListConstIterator &LinkedListConstIterator::operator++()
+{
+    ptr = ptr->next;
+    return *this;
+}
+
 
 /**
  * @brief LinkedList::LinkedList
@@ -31,16 +58,29 @@ LinkedList::LinkedList()
 
 }
 
+/**
+ * @brief LinkedList::LinkedList
+ * @param arena Where every link of this list is allocated.
+ * The arena must outlive the list, and the list must not be used after the arena is reset.
+ */
+LinkedList::LinkedList(LinkArena &arena) : arena(&arena)
+{
+}
+
 /**
  * @brief LinkedList::~LinkedList
- * Free every link in the list. Do this function last.
+ * Free every link in the list in a single pass, unless another list made
+ * by share() still uses them.
  */
 LinkedList::~LinkedList()
 {
-    // Consider using functions that already exist.
-    while (head != nullptr){
-        pop_back();
+    if (shared != nullptr){
+        if (shared->fetch_sub(1) != 1){
+            return;   // Another list still uses the chain
+        }
+        delete shared;
     }
+    free_chain(head);
 }
 
 /**
@@ -50,9 +90,20 @@ LinkedList::~LinkedList()
  */
 void LinkedList::push_front(Thing t)
 {
-    Link * temp = new Link(t);
+    sync();
+    unshare();
+    drop_finger();
+    Link * temp = make_link(t);
     temp->next = head;
     head = temp;
+    if (tail == nullptr){
+        tail = temp;
+    }
+    if (count != unknown_count){
+        ++count;
+    }
+    synced_head = head;
+    maybe_compact();
 }
 
 /**
@@ -61,9 +112,21 @@ void LinkedList::push_front(Thing t)
  */
 void LinkedList::pop_front()
 {
+    sync();
+    unshare();
+    drop_finger();
     Link *temp = head;
     head = head->next;
-    delete temp;
+    free_link(temp);
+    if (head == nullptr){
+        tail = nullptr;
+        count = 0;
+    }
+    else if (count != unknown_count){
+        --count;
+    }
+    synced_head = head;
+    maybe_compact();
 }
 
 /**
@@ -73,17 +136,21 @@ void LinkedList::pop_front()
  */
 void LinkedList::push_back(Thing t)
 {
-    Link *curr = head;
-    Link *temp = new Link(t);
+    sync();
+    unshare();
+    Link *temp = make_link(t);
     if (head == nullptr){
         head = temp;
     }
     else{
-        while (curr->next != nullptr){
-             curr = curr->next;
-        }
-        curr->next = temp;
+        tail->next = temp;
     }
+    tail = temp;
+    if (count != unknown_count){
+        ++count;
+    }
+    synced_head = head;
+    maybe_compact();
 }
 
 /**
@@ -92,42 +159,43 @@ void LinkedList::push_back(Thing t)
  */
 void LinkedList::pop_back()
 {
-
+    sync();
+    unshare();
     Link *curr = head;
     if (curr->next == nullptr){
-        std::cout<< head->value.i << std::endl;
-        delete curr;
+        drop_finger();
+        free_link(curr);
         head = nullptr;
-
-
+        tail = nullptr;
+        count = 0;
     }
-   else{
-        while (curr->next->next != nullptr){
+    else{
+        // Singly linked, so the new tail still has to be found from the front.
+        while (curr->next != tail){
              curr = curr->next;
         }
-        delete curr->next;
+        if (finger.link == tail){
+            drop_finger();
+        }
+        free_link(tail);
         curr->next = nullptr;
+        tail = curr;
+        if (count != unknown_count){
+            --count;
+        }
     }
-
+    synced_head = head;
+    maybe_compact();
 }
 
 /**
  * @brief LinkedList::size
  * @return number of items in the list
  */
-size_t LinkedList::size()
+size_t LinkedList::size() const
 {
-    if (head == nullptr){
-        return 0;
-    }
-    size_t counter = 0;
-    Link * curr = head;
-    while (curr->next != nullptr){
-        curr = curr->next;
-        ++counter;
-    }
-    ++counter;
-    return counter;
+    sync();
+    return known_count();
 }
 
 /**
@@ -136,6 +204,7 @@ size_t LinkedList::size()
  */
 Thing &LinkedList::front()
 {
+    unshare();
     return head->value;
 }
 
@@ -145,14 +214,28 @@ Thing &LinkedList::front()
  */
 Thing &LinkedList::back()
 {
-    if (head == nullptr){
-        return head->value;
-    }
-    Link * curr = head;
-    while (curr->next != nullptr){
-        curr = curr->next;
-    }
-    return curr->value;
+    sync();
+    unshare();
+    return tail->value;
+}
+
+/**
+ * @brief LinkedList::front
+ * @return a const reference to the first item, without unsharing the list
+ */
+const Thing &LinkedList::front() const
+{
+    return head->value;
+}
+
+/**
+ * @brief LinkedList::back
+ * @return a const reference to the last item, without unsharing the list
+ */
+const Thing &LinkedList::back() const
+{
+    sync();
+    return tail->value;
 }
 
 /**
@@ -163,15 +246,7 @@ Thing &LinkedList::back()
  */
 Link *LinkedList::get_link(int i)
 {
-    if (i > size() - 1 || i < 0){
-        throw std::out_of_range("i out of bounds");
-    }
-    Link * curr = head;
-    for (size_t j = 0;j<i; j++){
-        curr = curr->next;
-    }
-    return curr;
-
+    return seek(finger, i);
 }
 
 /**
@@ -186,6 +261,38 @@ Thing &LinkedList::at(int i)
     return get_link(i)->value;
 }
 
+/**
+ * @brief LinkedList::at
+ * @param i
+ * @return A const reference to the thing at index i, without unsharing the list
+ * @throws std::out_of_range("i out of bounds")
+ */
+const Thing &LinkedList::at(int i) const
+{
+    return walk_to(finger, i)->value;
+}
+
+/**
+ * @brief LinkedList::seek
+ * @param cursor A cursor on this list, or a new one
+ * @param i
+ * @return A pointer to the ith link, where cursor now is. Walks on from
+ * the cursor if it is at or before i, otherwise from head. If the list
+ * has to copy shared links first, the cursor is moved onto the copy.
+ * @throws std::out_of_range("i out of bounds")
+ */
+Link *LinkedList::seek(LinkedListCursor &cursor, int i)
+{
+    sync();
+    if (&cursor == &finger){
+        unshare();   // Drops the finger, which is then walked from head
+    }
+    else{
+        unshare_keeping(&cursor.link);
+    }
+    return walk_to(cursor, i);
+}
+
 /**
  * @brief LinkedList::begin
  * @return a LinkedListIterator object referencing the first item
@@ -195,6 +302,7 @@ LinkedListIterator LinkedList::begin()
     // Remember to implemente both LinkedListIterator::operator* and
     //   LinkedListIterator::operator++ in order to pass the test cases.
     // They are at the top of this file.
+    unshare();
     LinkedListIterator iter;
     iter.ptr = head;
     return iter;
@@ -212,18 +320,46 @@ LinkedListIterator LinkedList::end()
         return last;
 }
 
+/**
+ * @brief LinkedList::begin
+ * @return a LinkedListConstIterator referencing the first item, without unsharing the list
+ */
+LinkedListConstIterator LinkedList::begin() const
+{
+    LinkedListConstIterator iter;
+    iter.ptr = head;
+    return iter;
+}
+
+/**
+ * @brief LinkedList::end
+ * @return a LinkedListConstIterator representing one past the last item
+ */
+LinkedListConstIterator LinkedList::end() const
+{
+    LinkedListConstIterator last;
+    last.ptr = nullptr;
+    return last;
+}
+
 /**
  * @brief LinkedList::copy
  * @return A pointer to a copy of the list
  * Allocate a new list on the heap, then add all the items to the list.
  * Do not allocate the list on the stack, because it would be destroyed when the function ends.
  *  - See the C++ Concepts PDF example.
+ * The copy's links are allocated in batches by clone_from().
  */
 LinkedList *LinkedList::copy()
 {
-    LinkedList * myList = new LinkedList;
-    for (size_t i = 0;i<size();i++){
-        myList->push_back(at(i));
+    sync();
+    LinkedList * myList = arena != nullptr ? new LinkedList(*arena) : new LinkedList;
+    try{
+        myList->clone_from(head);
+    }
+    catch (...){
+        delete myList;
+        throw;
     }
     return myList;
 }
@@ -240,6 +376,13 @@ LinkedList *LinkedList::copy()
  */
 void LinkedList::reverse()
 {
+    sync();
+    unshare();
+    drop_finger();
+    if (head == nullptr){
+        return;
+    }
+    tail = head;
     Link * curr = head;
     Link * prev = nullptr;
     Link * temp = nullptr;
@@ -251,6 +394,598 @@ void LinkedList::reverse()
     }
     curr->next = prev; //change the null ptr to the previous one
     head = curr;
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::sort
+ * Sort the list by Thing::i, smallest first. See sort(comp).
+ */
+void LinkedList::sort()
+{
+    sort([](const Thing &a, const Thing &b){ return a.i < b.i; });
+}
 
+/**
+ * @brief LinkedList::merge
+ * @param other A list sorted by Thing::i, emptied by the merge
+ * Merge other into this list, which is also sorted by Thing::i. See merge(other, comp).
+ */
+void LinkedList::merge(LinkedList &other)
+{
+    merge(other, [](const Thing &a, const Thing &b){ return a.i < b.i; });
+}
+
+/**
+ * @brief LinkedList::concat
+ * @param other Emptied, its links are moved to the back of this list
+ * O(1).
+ * @throws std::invalid_argument if the lists allocate differently or other is this list
+ */
+void LinkedList::concat(LinkedList &other)
+{
+    check_distinct(other);
+    sync();
+    unshare();
+    LinkedListIterator last;
+    last.ptr = tail;
+    splice_after(last, other);
+}
+
+/**
+ * @brief LinkedList::splice_after
+ * @param pos A link of this list, or end() for the front
+ * @param other Emptied, all its links are moved in after pos
+ * O(1), or O(n) if this list has to stop sharing its links first.
+ * @throws std::invalid_argument if the lists allocate differently or other is this list
+ */
+void LinkedList::splice_after(LinkedListIterator pos, LinkedList &other)
+{
+    check_same_allocator(other);
+    check_distinct(other);
+    sync();
+    other.sync();
+    other.unshare();
+    if (other.head == nullptr){
+        return;
+    }
+    unshare_keeping(&pos.ptr);
+    drop_finger();
+    other.drop_finger();
+    Link *after = pos.ptr != nullptr ? pos.ptr->next : head;
+    if (pos.ptr != nullptr){
+        pos.ptr->next = other.head;
+    }
+    else{
+        head = other.head;
+    }
+    other.tail->next = after;
+    if (after == nullptr){
+        tail = other.tail;
+    }
+    take_all(other);
+}
+
+/**
+ * @brief LinkedList::splice_after
+ * @param pos A link of this list, or end() for the front. Not in the moved range.
+ * @param other The list the links come from, may be this list
+ * @param before_first The link of other before the first one to move, or end() to start at its front
+ * @param last The last link to move, somewhere after before_first
+ * Move the links after before_first up to and including last from other
+ * to just after pos. O(1), unless a list has to stop sharing its links
+ * first; both lists recount on the next size().
+ * @throws std::invalid_argument if the lists allocate differently
+ */
+void LinkedList::splice_after(LinkedListIterator pos, LinkedList &other,
+                              LinkedListIterator before_first, LinkedListIterator last)
+{
+    check_same_allocator(other);
+    sync();
+    other.sync();
+    if (&other == this){
+        Link **positions[] = {&pos.ptr, &before_first.ptr, &last.ptr};
+        unshare_keeping(positions, 3);
+    }
+    else{
+        Link **positions[] = {&before_first.ptr, &last.ptr};
+        unshare_keeping(&pos.ptr);
+        other.unshare_keeping(positions, 2);
+    }
+    drop_finger();
+    other.drop_finger();
+
+    Link *first = before_first.ptr != nullptr ? before_first.ptr->next : other.head;
+    if (before_first.ptr != nullptr){
+        before_first.ptr->next = last.ptr->next;
+    }
+    else{
+        other.head = last.ptr->next;
+    }
+    if (other.tail == last.ptr){
+        other.tail = before_first.ptr;
+    }
+    if (&other != this){
+        other.count = other.head == nullptr ? 0 : unknown_count;
+        count = unknown_count;
+    }
+    other.synced_head = other.head;
+
+    Link *after = pos.ptr != nullptr ? pos.ptr->next : head;
+    if (pos.ptr != nullptr){
+        pos.ptr->next = first;
+    }
+    else{
+        head = first;
+    }
+    last.ptr->next = after;
+    if (after == nullptr){
+        tail = last.ptr;
+    }
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::split_after
+ * @param pos A link of this list
+ * @return A pointer to a new list holding every link after pos, which is
+ * now the last link of this list. O(1), or O(n) if this list has to stop
+ * sharing its links first; both lists recount on the next size().
+ */
+LinkedList *LinkedList::split_after(LinkedListIterator pos)
+{
+    sync();
+    unshare_keeping(&pos.ptr);
+    drop_finger();
+    LinkedList * myList = arena != nullptr ? new LinkedList(*arena) : new LinkedList;
+    myList->head = pos.ptr->next;
+    myList->synced_head = myList->head;
+    if (myList->head != nullptr){
+        myList->tail = tail;
+        myList->count = unknown_count;
+        count = unknown_count;
+    }
+    pos.ptr->next = nullptr;
+    tail = pos.ptr;
+    return myList;
+}
+
+/**
+ * @brief LinkedList::share
+ * @return A pointer to a new list with the same items that shares this
+ * list's links until either list is modified. O(1).
+ */
+LinkedList *LinkedList::share()
+{
+    sync();
+    if (shared == nullptr){
+        shared = new std::atomic<size_t>(1);
+    }
+    ++*shared;
+    LinkedList * myList = arena != nullptr ? new LinkedList(*arena) : new LinkedList;
+    myList->head = head;
+    myList->tail = tail;
+    myList->count = count;
+    myList->synced_head = head;
+    myList->shared = shared;
+    return myList;
+}
+
+/**
+ * @brief LinkedList::is_shared
+ * @return true if another list made by share() still uses this list's links
+ */
+bool LinkedList::is_shared()
+{
+    return shared != nullptr && shared->load() > 1;
+}
+
+/**
+ * @brief LinkedList::unshare
+ * Give this list its own copy of the links if they are shared. O(1) if not.
+ * If the copy cannot be made the list is left sharing the old links.
+ */
+void LinkedList::unshare()
+{
+    if (shared == nullptr){
+        return;
+    }
+    if (shared->load() == 1){
+        // The other lists are gone, the chain is ours alone.
+        delete shared;
+        shared = nullptr;
+        return;
+    }
+    Link *old_head = head;
+    clone_from(old_head);
+    drop_finger();
+    if (shared->fetch_sub(1) == 1){
+        // The last other user went away while we were copying.
+        delete shared;
+        free_chain(old_head);
+    }
+    shared = nullptr;
+}
+
+/**
+ * @brief LinkedList::compact
+ * Move every link into fresh memory in list order and free the old ones.
+ * Arena lists get one contiguous block from the arena; the old links stay
+ * in the arena until it is reset. Otherwise each link must still be freed
+ * on its own, so all n come from one Link::allocate_n call (adjacent when
+ * carved from a fresh slab) and are handed out in address order. Every
+ * Link*, iterator and cursor into the list is invalid afterwards.
+ */
+void LinkedList::compact()
+{
+    sync();
+    unshare();
+    drop_finger();
+    updates_since_check = 0;
+    size_t n = known_count();
+    if (n == 0){
+        return;
+    }
+    Link ** block = new Link*[n];
+    try{
+        if (arena != nullptr){
+            Link * links = static_cast<Link*>(arena->allocate(n * sizeof(Link), alignof(Link)));
+            for (size_t i = 0; i < n; ++i){
+                block[i] = links + i;
+            }
+        }
+        else{
+            Link::allocate_n(block, n);
+        }
+    }
+    catch (...){
+        delete [] block;
+        throw;   // The list is left as it was
+    }
+    if (arena == nullptr){
+        std::sort(block, block + n, std::less<Link*>());
+    }
+    Link * old = head;
+    for (size_t i = 0; i < n; ++i){
+        ::new (block[i]) Link(old->value);
+        block[i]->next = i + 1 < n ? block[i + 1] : nullptr;
+        Link * next = old->next;
+        free_link(old);
+        old = next;
+    }
+    head = block[0];
+    tail = block[n - 1];
+    synced_head = head;
+    delete [] block;
+}
+
+/**
+ * @brief LinkedList::fragmentation
+ * @return The fraction of next pointers that do not lead forwards by at
+ * most 256 bytes, which a hardware prefetcher streaming forwards would
+ * already have fetched. From 0 for a compacted list to about 1 for links
+ * scattered over the heap. 0 for lists with fewer than two links.
+ */
+double LinkedList::fragmentation()
+{
+    size_t hops = 0;
+    size_t far = 0;
+    for (Link * curr = head; curr != nullptr && curr->next != nullptr; curr = curr->next){
+        std::uintptr_t from = reinterpret_cast<std::uintptr_t>(curr);
+        std::uintptr_t to = reinterpret_cast<std::uintptr_t>(curr->next);
+        if (to <= from || to - from > 256){
+            ++far;
+        }
+        ++hops;
+    }
+    return hops == 0 ? 0 : double(far) / hops;
+}
+
+/**
+ * @brief LinkedList::set_auto_compact
+ * @param threshold Compact once fragmentation() is above this, 0 to stop
+ * Let push and pop compact the list now and then. There is no background
+ * thread: the list is not thread safe, so the check runs inline, at most
+ * once every size() updates.
+ */
+void LinkedList::set_auto_compact(double threshold)
+{
+    compact_threshold = threshold;
+    updates_since_check = 0;
+}
+
+/**
+ * @brief LinkedList::maybe_compact
+ * Count an update and, when auto compaction is on and enough updates have
+ * gone by, compact the list if it has become fragmented.
+ */
+void LinkedList::maybe_compact()
+{
+    if (compact_threshold <= 0){
+        return;
+    }
+    size_t interval = known_count() > min_compact_interval ? known_count() : min_compact_interval;
+    if (++updates_since_check < interval){
+        return;
+    }
+    updates_since_check = 0;
+    if (fragmentation() > compact_threshold){
+        compact();
+    }
+}
+
+/**
+ * @brief LinkedList::unshare_keeping
+ * @param positions n pointers to links of this list, each may point to nullptr
+ * @param n At most 3
+ * unshare(), then move each position onto the copy of the link it held, so
+ * that iterators taken while the chain was shared still point into this list.
+ */
+void LinkedList::unshare_keeping(Link ***positions, size_t n)
+{
+    if (shared == nullptr){
+        return;
+    }
+    const size_t none = size_t(-1);
+    size_t indexes[3] = {none, none, none};
+    Link *old_head = head;
+    size_t i = 0;
+    for (Link * curr = old_head; curr != nullptr; curr = curr->next, ++i){
+        for (size_t k = 0; k < n; ++k){
+            if (*positions[k] == curr){
+                indexes[k] = i;
+            }
+        }
+    }
+    unshare();
+    if (head == old_head){
+        return;   // Nobody else was using the chain, nothing was copied
+    }
+    i = 0;
+    for (Link * curr = head; curr != nullptr; curr = curr->next, ++i){
+        for (size_t k = 0; k < n; ++k){
+            if (indexes[k] == i){
+                *positions[k] = curr;
+            }
+        }
+    }
+}
+
+/**
+ * @brief LinkedList::unshare_keeping
+ * @param position A pointer to a link of this list, may point to nullptr
+ */
+void LinkedList::unshare_keeping(Link **position)
+{
+    Link **positions[] = {position};
+    unshare_keeping(positions, 1);
+}
+
+/**
+ * @brief LinkedList::make_link
+ * @param t
+ * @return A new link holding t, from the arena if the list has one
+ */
+Link *LinkedList::make_link(Thing t)
+{
+    if (arena != nullptr){
+        return ::new (arena->allocate(sizeof(Link), alignof(Link))) Link(t);
+    }
+    return new Link(t);
+}
+
+/**
+ * @brief LinkedList::free_link
+ * @param link
+ * Free a link made by make_link(). Arena links are only destroyed, their
+ * memory goes back when the arena is reset.
+ */
+void LinkedList::free_link(Link *link)
+{
+    if (arena != nullptr){
+        link->~Link();
+        return;
+    }
+    delete link;
+}
+
+/**
+ * @brief LinkedList::free_chain
+ * @param first
+ * Free first and every link after it in a single pass. Arena links are
+ * left to the arena, and when links are trivially destructible (as they
+ * are for Thing) that costs nothing at all.
+ */
+void LinkedList::free_chain(Link *first)
+{
+    if (arena != nullptr && std::is_trivially_destructible<Link>::value){
+        return;
+    }
+    while (first != nullptr){
+        Link *next = first->next;
+        free_link(first);
+        first = next;
+    }
+}
+
+/**
+ * @brief LinkedList::clone_from
+ * @param first
+ * Replace this list's links with copies of first and the links after it,
+ * without freeing the old ones. The copy is built by build_chain(), so its
+ * links are allocated in batches, and only installed once it is complete:
+ * if it throws, the list is left as it was.
+ */
+void LinkedList::clone_from(Link *first)
+{
+    LinkedListIterator from;
+    from.ptr = first;
+    Link * chain_head;
+    Link * chain_tail;
+    size_t k = build_chain(from, end(), chain_head, chain_tail);
+    head = chain_head;
+    tail = chain_tail;
+    count = k;
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::cut_after
+ * @param first
+ * @param n
+ * @return The links after the first n links starting at first, which are
+ * cut off from them. nullptr if there are no more than n.
+ */
+Link *LinkedList::cut_after(Link *first, size_t n)
+{
+    for (size_t i = 1; first != nullptr && i < n; ++i){
+        first = first->next;
+    }
+    if (first == nullptr){
+        return nullptr;
+    }
+    Link *rest = first->next;
+    first->next = nullptr;
+    return rest;
+}
+
+/**
+ * @brief LinkedList::check_same_allocator
+ * @param other
+ * @throws std::invalid_argument if links of other could not be freed by this list
+ */
+void LinkedList::check_same_allocator(LinkedList &other)
+{
+    if (arena != other.arena){
+        throw std::invalid_argument("lists allocate their links differently");
+    }
+}
+
+/**
+ * @brief LinkedList::check_distinct
+ * @param other
+ * @throws std::invalid_argument if other is this list, whose links would be linked to themselves
+ */
+void LinkedList::check_distinct(LinkedList &other)
+{
+    if (&other == this){
+        throw std::invalid_argument("cannot move a list's links into itself");
+    }
+}
+
+/**
+ * @brief LinkedList::take_all
+ * @param other
+ * Finish moving every link of other into this list: the links are already
+ * linked in and tail is set, so add up the counts and leave other empty.
+ */
+void LinkedList::take_all(LinkedList &other)
+{
+    if (count != unknown_count && other.count != unknown_count){
+        count += other.count;
+    }
+    else{
+        count = unknown_count;
+    }
+    synced_head = head;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.count = 0;
+    other.synced_head = nullptr;
+}
+
+/**
+ * @brief LinkedList::known_count
+ * @return count, after recounting the list if it is unknown
+ */
+size_t LinkedList::known_count() const
+{
+    if (count == unknown_count){
+        count = 0;
+        for (Link * curr = head; curr != nullptr; curr = curr->next){
+            ++count;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief LinkedList::drop_finger
+ * Forget where get_link() last stopped.
+ */
+void LinkedList::drop_finger() const
+{
+    finger = LinkedListCursor();
+}
+
+/**
+ * @brief LinkedList::walk_to
+ * @param cursor A cursor on this list, or a new one
+ * @param i
+ * @return A pointer to the ith link, where cursor now is. Walks on from
+ * the cursor if it is at or before i, otherwise from head.
+ * @throws std::out_of_range("i out of bounds")
+ */
+Link *LinkedList::walk_to(LinkedListCursor &cursor, int i) const
+{
+    sync();
+    if (i < 0 || size_t(i) >= known_count()){
+        throw std::out_of_range("i out of bounds");
+    }
+    if (cursor.link == nullptr || size_t(i) < cursor.index){
+        cursor.link = head;
+        cursor.index = 0;
+    }
+    while (cursor.index < size_t(i)){
+        ++cursor;
+    }
+    return cursor.link;
+}
+
+/**
+ * @brief LinkedList::resync
+ * Recount the list and find its tail after links past head were changed
+ * from outside, e.g. by cutting the list short or freeing its last link.
+ * Changing head itself, or linking more links after the last one, is
+ * noticed without this.
+ */
+void LinkedList::resync()
+{
+    recount();
+}
+
+/**
+ * @brief LinkedList::sync
+ * Recount the list and find its tail if head was changed, or links were
+ * added after tail, without going through a member function. O(1) when
+ * the cache is still valid.
+ */
+void LinkedList::sync() const
+{
+    if (head != synced_head){
+        recount();
+        return;
+    }
+    // head is unchanged, so tail is still one of the list's links unless it
+    //   was freed from outside, which needs resync() first.
+    if (tail != nullptr && tail->next != nullptr){
+        recount();
+    }
+}
+
+/**
+ * @brief LinkedList::recount
+ * Walk the whole list to find tail and count, and forget the finger.
+ */
+void LinkedList::recount() const
+{
+    drop_finger();
+    tail = nullptr;
+    count = 0;
+    for (Link * curr = head; curr != nullptr; curr = curr->next){
+        tail = curr;
+        ++count;
+    }
+    synced_head = head;
 }
 
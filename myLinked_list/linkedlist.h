@@ -3,6 +3,8 @@
 
 #include<stdexcept>
 #include<iostream>
+#include<atomic>
+#include<new>
 
 // Disables vector<T>, forward_list<T> and list<T> in STL
 #define _GLIBCXX_VECTOR 1
@@ -36,6 +38,10 @@ public:
 
    void* operator new(size_t sz);
    void operator delete(void* ptr);
+
+   // Uninitialised memory for k links at once, each one freed with operator
+   //   delete. If it throws, none of the k are left allocated.
+   static void allocate_n(Link** out, size_t k);
 };
 
 
@@ -52,6 +58,35 @@ public:
    }
 };
 
+// Read-only iterator, from begin() and end() on a const LinkedList.
+class LinkedListConstIterator{
+public:
+   const Link* ptr = nullptr; // Points to the current link.
+
+   const Thing& operator*();              // Dereference
+   LinkedListConstIterator& operator++(); // Increment
+
+   bool operator !=(const LinkedListConstIterator& other){
+       return ptr != other.ptr;
+   }
+};
+
+
+// Position in a LinkedList that knows its index, so walking forward by
+//   index can continue from it instead of starting at head. A cursor must
+//   not be used after links are removed or reordered, or after a shared
+//   list is given its own links by anything other than seek().
+class LinkedListCursor{
+public:
+   Link *link = nullptr;   // Current link, nullptr before the first seek
+   size_t index = 0;       // Index of link
+
+   Thing& operator*(){ return link->value; }
+   LinkedListCursor& operator++(){ link = link->next; ++index; return *this; }
+};
+
+
+class LinkArena;
 
 // Our Linked List
 class LinkedList{
@@ -60,6 +95,7 @@ public:
 
 
    LinkedList();
+   explicit LinkedList(LinkArena& arena);
    ~LinkedList();
 
    void push_front(Thing t);
@@ -68,19 +104,347 @@ public:
    void push_back(Thing t);
    void pop_back();
 
-   size_t size();
+   size_t size() const;
 
    Thing& front();
    Thing& back();
+   const Thing& front() const;
+   const Thing& back() const;
 
    Link*  get_link(int i);
    Thing& at(int i);
+   const Thing& at(int i) const;
+   Link*  seek(LinkedListCursor& cursor, int i);
 
    LinkedListIterator begin();
    LinkedListIterator end();
+   LinkedListConstIterator begin() const;
+   LinkedListConstIterator end() const;
+
+   void resync();
 
    LinkedList *copy();
    void reverse();
+
+   LinkedList *share();
+   bool is_shared();
+   void unshare();
+
+   template<class Compare>
+   void sort(Compare comp);
+   void sort();
+
+   // Moving links between lists. An iterator pos of end() stands for the
+   //   position before the first link. Both lists must allocate the same way
+   //   (same arena, or both none).
+   void concat(LinkedList& other);
+   void splice_after(LinkedListIterator pos, LinkedList& other);
+   void splice_after(LinkedListIterator pos, LinkedList& other,
+                     LinkedListIterator before_first, LinkedListIterator last);
+   LinkedList *split_after(LinkedListIterator pos);
+
+   template<class Compare>
+   void merge(LinkedList& other, Compare comp);
+   void merge(LinkedList& other);
+
+   template<class Iterator>
+   void append(Iterator first, Iterator last);
+   template<class Iterator>
+   void prepend(Iterator first, Iterator last);
+
+   // Relayout. compact() moves every link so that the list runs forwards
+   //   through memory; links, iterators and cursors into the list are
+   //   invalid afterwards. With auto compaction on, push and pop may do the
+   //   same, so no link may be held across them.
+   void compact();
+   double fragmentation();
+   void set_auto_compact(double threshold);
+
+private:
+   Link *make_link(Thing t);
+   void free_link(Link *link);
+   void free_chain(Link *first);
+   void clone_from(Link *first);
+   static Link *cut_after(Link *first, size_t n);
+   template<class Iterator>
+   size_t build_chain(Iterator first, Iterator last, Link *&chain_head, Link *&chain_tail);
+   void check_same_allocator(LinkedList& other);
+   void check_distinct(LinkedList& other);
+   void unshare_keeping(Link*** positions, size_t n);
+   void unshare_keeping(Link** position);
+   void take_all(LinkedList& other);
+
+   // Lists made by share() use the same chain of links until one of them
+   //   needs to change it. shared counts the lists using the chain, nullptr
+   //   when this list is the only one. Anything that may modify the chain,
+   //   including handing out a reference or iterator into it, unshares first.
+   //   Reading through a const LinkedList& leaves the chain shared.
+   //   head must not be rewired from outside while the chain is shared.
+   std::atomic<size_t> *shared = nullptr;
+
+   // Lists built on an arena take their links from it and never free them
+   //   one by one; the arena releases them all at once.
+   LinkArena *arena = nullptr;
+
+   // tail and count make push_back, back() and size() O(1). Every member
+   //   function keeps them up to date. head is public and may be rewired from
+   //   outside, so they are only trusted while head is still synced_head and
+   //   nothing hangs off tail; otherwise sync() recounts the list once.
+   //   Edits further down that sync() cannot see, such as cutting the list
+   //   short or freeing its last link, must be followed by resync() before
+   //   any other call, since sync() reads tail->next. Splicing part of a list leaves
+   //   count as unknown_count, and known_count() recounts it the next time
+   //   it is needed. They are only caches, so const members refresh them too.
+   void sync() const;
+   void recount() const;
+   size_t known_count() const;
+
+   static const size_t unknown_count = size_t(-1);
+   mutable Link *tail = nullptr;
+   mutable size_t count = 0;
+   mutable Link *synced_head = nullptr;
+
+   // Where get_link() last stopped. A call for the same or a later index
+   //   walks on from here, so at(0), at(1), ... is O(n) overall. Anything
+   //   that inserts, removes or reorders links before the end drops it.
+   mutable LinkedListCursor finger;
+   void drop_finger() const;
+   Link *walk_to(LinkedListCursor& cursor, int i) const;
+
+   // Auto compaction, off while compact_threshold is 0. Every max(size(),
+   //   min_compact_interval) pushes and pops, fragmentation() is measured
+   //   and the list compacted if it is above the threshold, which keeps the
+   //   check O(1) amortised per operation.
+   static const size_t min_compact_interval = 64;
+   double compact_threshold = 0;
+   size_t updates_since_check = 0;
+   void maybe_compact();
 };
 
+/**
+ * @brief LinkedList::sort
+ * @param comp comp(a, b) is true if a goes before b
+ * Stable bottom-up merge sort that only relinks next pointers: O(n log n)
+ * time, O(1) extra space and no recursion. Lists that are already in
+ * order are left alone and lists in strictly reverse order are reversed,
+ * both after a single pass.
+ */
+template<class Compare>
+void LinkedList::sort(Compare comp)
+{
+    sync();
+    unshare();
+    if (known_count() < 2){
+        return;
+    }
+    bool ascending = true;
+    bool descending = true;
+    for (Link * curr = head; curr->next != nullptr && (ascending || descending); curr = curr->next){
+        if (comp(curr->next->value, curr->value)){
+            ascending = false;
+        }
+        else{
+            descending = false;   // Equal neighbours must keep their order
+        }
+    }
+    if (ascending){
+        return;
+    }
+    if (descending){
+        reverse();
+        return;
+    }
+    drop_finger();
+
+    // Merge neighbouring runs of width links, doubling width each pass.
+    for (size_t width = 1; width < count; width *= 2){
+        Link * rest = head;
+        Link ** out = &head;      // Where the next merged link is attached
+        Link * last = nullptr;
+        while (rest != nullptr){
+            Link * left = rest;
+            Link * right = cut_after(left, width);
+            rest = cut_after(right, width);
+            while (left != nullptr && right != nullptr){
+                if (comp(right->value, left->value)){
+                    *out = right;
+                    right = right->next;
+                }
+                else{
+                    *out = left;
+                    left = left->next;
+                }
+                last = *out;
+                out = &last->next;
+            }
+            Link * remaining = left != nullptr ? left : right;
+            *out = remaining;
+            for (; remaining != nullptr; remaining = remaining->next){
+                last = remaining;
+            }
+            out = &last->next;
+        }
+        tail = last;
+    }
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::merge
+ * @param other A list sorted by comp, emptied by the merge
+ * @param comp comp(a, b) is true if a goes before b
+ * Merge other into this list, which is also sorted by comp, by relinking
+ * only. Stable: of two equal items, the one from this list comes first.
+ * @throws std::invalid_argument if the lists allocate differently or other is this list
+ */
+template<class Compare>
+void LinkedList::merge(LinkedList &other, Compare comp)
+{
+    check_same_allocator(other);
+    check_distinct(other);
+    sync();
+    unshare();
+    other.sync();
+    other.unshare();
+    drop_finger();
+    other.drop_finger();
+
+    Link * a = head;
+    Link * b = other.head;
+    Link ** out = &head;
+    while (a != nullptr && b != nullptr){
+        if (comp(b->value, a->value)){
+            *out = b;
+            b = b->next;
+        }
+        else{
+            *out = a;
+            a = a->next;
+        }
+        out = &(*out)->next;
+    }
+    if (b != nullptr){
+        *out = b;
+        tail = other.tail;
+    }
+    else{
+        *out = a;
+    }
+    take_all(other);
+}
+
+/**
+ * @brief LinkedList::append
+ * @param first
+ * @param last
+ * Add the items in [first, last) to the back of the list, in order. The
+ * links are allocated in batches and chained up before the list is
+ * touched, then attached with a single pointer write.
+ */
+template<class Iterator>
+void LinkedList::append(Iterator first, Iterator last)
+{
+    Link * chain_head;
+    Link * chain_tail;
+    size_t k = build_chain(first, last, chain_head, chain_tail);
+    if (k == 0){
+        return;
+    }
+    sync();
+    unshare();
+    if (head == nullptr){
+        head = chain_head;
+    }
+    else{
+        tail->next = chain_head;
+    }
+    tail = chain_tail;
+    if (count != unknown_count){
+        count += k;
+    }
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::prepend
+ * @param first
+ * @param last
+ * Add the items in [first, last) to the front of the list, keeping their
+ * order. Built like append().
+ */
+template<class Iterator>
+void LinkedList::prepend(Iterator first, Iterator last)
+{
+    Link * chain_head;
+    Link * chain_tail;
+    size_t k = build_chain(first, last, chain_head, chain_tail);
+    if (k == 0){
+        return;
+    }
+    sync();
+    unshare();
+    drop_finger();
+    chain_tail->next = head;
+    head = chain_head;
+    if (tail == nullptr){
+        tail = chain_tail;
+    }
+    if (count != unknown_count){
+        count += k;
+    }
+    synced_head = head;
+}
+
+/**
+ * @brief LinkedList::build_chain
+ * @return The number of links in a new chain holding [first, last),
+ * which runs from chain_head to chain_tail. Links come from
+ * Link::allocate_n a batch at a time, or from the arena. Iterator must
+ * be a forward iterator: each batch is counted before it is allocated.
+ */
+template<class Iterator>
+size_t LinkedList::build_chain(Iterator first, Iterator last, Link *&chain_head, Link *&chain_tail)
+{
+    static const size_t batch = 64;
+    Link * block[batch];
+    Link ** next = &chain_head;
+    chain_tail = nullptr;
+    size_t k = 0;
+    size_t n = 0;   // Links in the current batch, once allocated
+    size_t j = 0;   // Links of the current batch built so far
+    try{
+        while (first != last){
+            n = 0;
+            j = 0;
+            size_t wanted = 0;
+            for (Iterator probe = first; wanted < batch && probe != last; ++probe){
+                ++wanted;
+            }
+            if (arena == nullptr){
+                Link::allocate_n(block, wanted);
+            }
+            n = wanted;
+            for (; j < n; ++j, ++first){
+                chain_tail = arena != nullptr ? make_link(*first) : ::new (block[j]) Link(*first);
+                *next = chain_tail;
+                next = &chain_tail->next;
+            }
+            k += n;
+        }
+    }
+    catch (...){
+        *next = nullptr;
+        free_chain(chain_head);
+        if (arena == nullptr){
+            // Slots of the batch that were allocated but never built
+            for (; j < n; ++j){
+                Link::operator delete(block[j]);
+            }
+        }
+        throw;
+    }
+    *next = nullptr;
+    return k;
+}
+
 #endif // MYLINKEDLIST_H
@@ -0,0 +1,149 @@
+#include "lockfreequeue.h"
+
+/**
+ * @brief LockFreeQueue::LockFreeQueue
+ * Construct an empty queue: head and tail both point at one dummy node.
+ */
+LockFreeQueue::LockFreeQueue() : free_top(TaggedPtr<QueueNode>()), n_nodes(0)
+{
+    QueueNode *dummy = get_node();
+    head.store(TaggedPtr<QueueNode>(dummy, 0));
+    tail.store(TaggedPtr<QueueNode>(dummy, 0));
+}
+
+/**
+ * @brief LockFreeQueue::~LockFreeQueue
+ * Delete every node: the dummy, the queued items and the free list.
+ * No other thread may be using the queue.
+ */
+LockFreeQueue::~LockFreeQueue()
+{
+    QueueNode *lists[] = {head.load().ptr(), free_top.load().ptr()};
+    for (QueueNode *curr : lists){
+        while (curr != nullptr){
+            QueueNode *next = curr->next.load(std::memory_order_relaxed).ptr();
+            delete curr;
+            curr = next;
+        }
+    }
+}
+
+/**
+ * @brief LockFreeQueue::push
+ * @param t
+ * Add t at the back of the queue.
+ */
+void LockFreeQueue::push(Thing t)
+{
+    QueueNode *node = get_node();
+    node->value.store(t, std::memory_order_relaxed);
+    node->next.store(node->next.load(std::memory_order_relaxed).successor(nullptr), std::memory_order_relaxed);
+
+    TaggedPtr<QueueNode> last;
+    for (;;){
+        last = tail.load(std::memory_order_acquire);
+        TaggedPtr<QueueNode> next = last.ptr()->next.load(std::memory_order_acquire);
+        if (last != tail.load(std::memory_order_acquire)){
+            continue;
+        }
+        if (next.ptr() == nullptr){
+            if (last.ptr()->next.compare_exchange_weak(next, next.successor(node),
+                                                       std::memory_order_release, std::memory_order_relaxed)){
+                break;
+            }
+        }
+        else{
+            // tail is lagging behind, help the other push finish.
+            tail.compare_exchange_weak(last, last.successor(next.ptr()),
+                                       std::memory_order_release, std::memory_order_relaxed);
+        }
+    }
+    tail.compare_exchange_strong(last, last.successor(node),
+                                 std::memory_order_release, std::memory_order_relaxed);
+}
+
+/**
+ * @brief LockFreeQueue::try_pop
+ * @param out Receives the front item
+ * @return false if the queue was empty
+ */
+bool LockFreeQueue::try_pop(Thing &out)
+{
+    TaggedPtr<QueueNode> first;
+    Thing value;
+    for (;;){
+        first = head.load(std::memory_order_acquire);
+        TaggedPtr<QueueNode> last = tail.load(std::memory_order_acquire);
+        TaggedPtr<QueueNode> next = first.ptr()->next.load(std::memory_order_acquire);
+        if (first != head.load(std::memory_order_acquire)){
+            continue;
+        }
+        if (first.ptr() == last.ptr()){
+            if (next.ptr() == nullptr){
+                return false;
+            }
+            tail.compare_exchange_weak(last, last.successor(next.ptr()),
+                                       std::memory_order_release, std::memory_order_relaxed);
+        }
+        else{
+            // Read before the CAS: once head moves, next may be dequeued and reused.
+            value = next.ptr()->value.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(first, first.successor(next.ptr()),
+                                           std::memory_order_acquire, std::memory_order_relaxed)){
+                break;
+            }
+        }
+    }
+    out = value;
+    recycle(first.ptr());
+    return true;
+}
+
+/**
+ * @brief LockFreeQueue::empty_approx
+ * @return true if the queue was empty at some point during the call
+ */
+bool LockFreeQueue::empty_approx() const
+{
+    return head.load(std::memory_order_acquire).ptr()->next.load(std::memory_order_relaxed).ptr() == nullptr;
+}
+
+/**
+ * @brief LockFreeQueue::allocated_nodes
+ * @return The number of nodes ever allocated, the dummy included
+ */
+size_t LockFreeQueue::allocated_nodes() const
+{
+    return n_nodes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Take a node from the free list, or allocate a new one if it is empty.
+ */
+QueueNode *LockFreeQueue::get_node()
+{
+    TaggedPtr<QueueNode> old_free = free_top.load(std::memory_order_acquire);
+    while (old_free.ptr() != nullptr){
+        QueueNode *next = old_free.ptr()->next.load(std::memory_order_relaxed).ptr();
+        if (free_top.compare_exchange_weak(old_free, old_free.successor(next),
+                                           std::memory_order_acquire, std::memory_order_acquire)){
+            return old_free.ptr();
+        }
+    }
+    n_nodes.fetch_add(1, std::memory_order_relaxed);
+    return new QueueNode;
+}
+
+/**
+ * Put a former dummy node on the free list. Its next tag keeps counting up,
+ * so a push still holding it as tail cannot link onto it by mistake.
+ */
+void LockFreeQueue::recycle(QueueNode *node)
+{
+    TaggedPtr<QueueNode> old_free = free_top.load(std::memory_order_relaxed);
+    do{
+        node->next.store(node->next.load(std::memory_order_relaxed).successor(old_free.ptr()),
+                         std::memory_order_relaxed);
+    } while (!free_top.compare_exchange_weak(old_free, old_free.successor(node),
+                                             std::memory_order_release, std::memory_order_relaxed));
+}
@@ -0,0 +1,60 @@
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <atomic>
+#include "linkedlist.h"
+#include "taggedptr.h"
+
+// Node of a LockFreeQueue. Both fields may be read by a thread that lost
+//   a race while the node is being reused, so both are atomic.
+struct QueueNode{
+   std::atomic<Thing> value;
+   std::atomic<TaggedPtr<QueueNode>> next;
+
+   QueueNode() : value(Thing()), next(TaggedPtr<QueueNode>()){}
+};
+
+
+// Unbounded lock-free FIFO queue for any number of producer and consumer
+//   threads (Michael and Scott).
+//
+//   head points at a dummy node whose successor is the front item, tail at
+//   the last node or, briefly, the one before it; any thread that sees tail
+//   lagging swings it forward before going on. Enqueue links a node after
+//   the last one with a CAS on its next field, dequeue advances head with a
+//   CAS and turns the old dummy into garbage.
+//
+//   head, tail and every next field are TaggedPtrs whose tag is bumped on
+//   each write, and dequeued dummies go onto a free list owned by the queue
+//   (type stable, like LockFreeStack), so stale pointers are always safe to
+//   read and never win a CAS.
+//
+//   Allocate with automatic or static storage: C++11 operator new does
+//   not honour the over-alignment.
+class alignas(64) LockFreeQueue{
+public:
+   static constexpr size_t cache_line = 64;
+
+   LockFreeQueue();
+   ~LockFreeQueue();
+
+   LockFreeQueue(const LockFreeQueue&) = delete;
+   LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+   void push(Thing t);
+   bool try_pop(Thing& out);
+
+   bool empty_approx() const;
+   size_t allocated_nodes() const;
+
+private:
+   QueueNode* get_node();
+   void recycle(QueueNode* node);
+
+   alignas(cache_line) std::atomic<TaggedPtr<QueueNode>> head;  // Consumers
+   alignas(cache_line) std::atomic<TaggedPtr<QueueNode>> tail;  // Producers
+   alignas(cache_line) std::atomic<TaggedPtr<QueueNode>> free_top;
+   std::atomic<size_t> n_nodes;
+};
+
+#endif // LOCKFREEQUEUE_H
@@ -0,0 +1,193 @@
+#include "lockfreestack.h"
+
+#include <functional>
+#include <thread>
+
+/**
+ * @brief LockFreeStack::LockFreeStack
+ * @param eliminate false to never use the elimination array
+ */
+LockFreeStack::LockFreeStack(bool eliminate)
+    : top(TaggedPtr<StackNode>()), free_top(TaggedPtr<StackNode>()), n_nodes(0), eliminate(eliminate)
+{
+    for (Slot &slot : slots){
+        slot.offer.store(TaggedPtr<StackNode>(), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief LockFreeStack::~LockFreeStack
+ * Delete every node, both those on the stack and those on the free list.
+ * No other thread may be using the stack.
+ */
+LockFreeStack::~LockFreeStack()
+{
+    StackNode *lists[] = {top.load().ptr(), free_top.load().ptr()};
+    for (StackNode *curr : lists){
+        while (curr != nullptr){
+            StackNode *next = curr->next.load(std::memory_order_relaxed);
+            delete curr;
+            curr = next;
+        }
+    }
+}
+
+/**
+ * @brief LockFreeStack::push
+ * @param t
+ * Push t on top of the stack.
+ */
+void LockFreeStack::push(Thing t)
+{
+    StackNode *node = get_node();
+    node->value = t;
+
+    TaggedPtr<StackNode> old_top = top.load(std::memory_order_relaxed);
+    for (;;){
+        node->next.store(old_top.ptr(), std::memory_order_relaxed);
+        if (top.compare_exchange_weak(old_top, old_top.successor(node),
+                                      std::memory_order_release, std::memory_order_relaxed)){
+            return;
+        }
+        if (eliminate && offer_push(node)){
+            return;
+        }
+        old_top = top.load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief LockFreeStack::try_pop
+ * @param out Receives the top item
+ * @return false if the stack was empty
+ */
+bool LockFreeStack::try_pop(Thing &out)
+{
+    TaggedPtr<StackNode> old_top = top.load(std::memory_order_acquire);
+    for (;;){
+        StackNode *node = old_top.ptr();
+        if (node == nullptr){
+            return false;
+        }
+        // node may already be popped and reused; then the CAS fails.
+        StackNode *next = node->next.load(std::memory_order_relaxed);
+        if (top.compare_exchange_weak(old_top, old_top.successor(next),
+                                      std::memory_order_acquire, std::memory_order_acquire)){
+            out = node->value;
+            recycle(node);
+            return true;
+        }
+        if (eliminate){
+            StackNode *offered = take_offer();
+            if (offered != nullptr){
+                out = offered->value;
+                recycle(offered);
+                return true;
+            }
+            old_top = top.load(std::memory_order_acquire);
+        }
+    }
+}
+
+/**
+ * @brief LockFreeStack::empty_approx
+ * @return true if the stack was empty at some point during the call
+ */
+bool LockFreeStack::empty_approx() const
+{
+    return top.load(std::memory_order_relaxed).ptr() == nullptr;
+}
+
+/**
+ * @brief LockFreeStack::allocated_nodes
+ * @return The number of nodes ever allocated. Nodes are reused, so this
+ * is the high water mark of items on the stack plus items in flight.
+ */
+size_t LockFreeStack::allocated_nodes() const
+{
+    return n_nodes.load(std::memory_order_relaxed);
+}
+
+/**
+ * Take a node from the free list, or allocate a new one if it is empty.
+ * The free list is a Treiber stack of its own.
+ */
+StackNode *LockFreeStack::get_node()
+{
+    TaggedPtr<StackNode> old_free = free_top.load(std::memory_order_acquire);
+    while (old_free.ptr() != nullptr){
+        StackNode *next = old_free.ptr()->next.load(std::memory_order_relaxed);
+        if (free_top.compare_exchange_weak(old_free, old_free.successor(next),
+                                           std::memory_order_acquire, std::memory_order_acquire)){
+            return old_free.ptr();
+        }
+    }
+    n_nodes.fetch_add(1, std::memory_order_relaxed);
+    return new StackNode;
+}
+
+/**
+ * Put a node that no longer holds an item on the free list.
+ */
+void LockFreeStack::recycle(StackNode *node)
+{
+    TaggedPtr<StackNode> old_free = free_top.load(std::memory_order_relaxed);
+    do{
+        node->next.store(old_free.ptr(), std::memory_order_relaxed);
+    } while (!free_top.compare_exchange_weak(old_free, old_free.successor(node),
+                                             std::memory_order_release, std::memory_order_relaxed));
+}
+
+/**
+ * Park node in a random slot and wait a little for a pop to take it.
+ * Returns true if a pop took it, false if node was withdrawn (or the slot was busy).
+ */
+bool LockFreeStack::offer_push(StackNode *node)
+{
+    Slot &slot = slots[random_slot()];
+    TaggedPtr<StackNode> empty = slot.offer.load(std::memory_order_relaxed);
+    if (empty.ptr() != nullptr){
+        return false;
+    }
+    TaggedPtr<StackNode> parked = empty.successor(node);
+    if (!slot.offer.compare_exchange_strong(empty, parked, std::memory_order_release, std::memory_order_relaxed)){
+        return false;
+    }
+    for (int i = 0; i < elimination_spins; ++i){
+        if (slot.offer.load(std::memory_order_relaxed) != parked){
+            return true;
+        }
+    }
+    // The tag changes whenever a pop takes the node, even if the node is
+    // recycled and parked here again, so a failed withdrawal means it was taken.
+    return !slot.offer.compare_exchange_strong(parked, parked.successor(nullptr),
+                                               std::memory_order_relaxed, std::memory_order_relaxed);
+}
+
+/**
+ * Take a node parked by a push in a random slot.
+ * Returns the node, or nullptr if the slot was empty or someone else got it first.
+ */
+StackNode *LockFreeStack::take_offer()
+{
+    Slot &slot = slots[random_slot()];
+    TaggedPtr<StackNode> parked = slot.offer.load(std::memory_order_acquire);
+    if (parked.ptr() != nullptr &&
+        slot.offer.compare_exchange_strong(parked, parked.successor(nullptr),
+                                           std::memory_order_acquire, std::memory_order_relaxed)){
+        return parked.ptr();
+    }
+    return nullptr;
+}
+
+/**
+ * A per thread xorshift generator, seeded from the thread id.
+ */
+size_t LockFreeStack::random_slot()
+{
+    static thread_local uint32_t seed = uint32_t(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % elimination_slots;
+}
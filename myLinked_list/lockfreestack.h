@@ -0,0 +1,72 @@
+#ifndef LOCKFREESTACK_H
+#define LOCKFREESTACK_H
+
+#include <atomic>
+#include "linkedlist.h"
+#include "taggedptr.h"
+
+// Node of a LockFreeStack. next is atomic because a popping thread may
+//   read it while another thread is reusing the node.
+struct StackNode{
+   Thing value;
+   std::atomic<StackNode*> next;
+
+   StackNode() : next(nullptr){}
+};
+
+
+// Unbounded lock-free LIFO stack (Treiber stack) for any number of threads.
+//
+//   push and try_pop swing top with one CAS on a TaggedPtr, so a stale
+//   top that has been popped and pushed again is rejected.
+//
+//   Nodes are type stable: a popped node goes onto a free list owned by
+//   the stack and is only deleted with the stack. A thread still holding
+//   a stale node pointer can therefore always read its next field; the
+//   tag makes sure the value it read is never used.
+//
+//   Under contention a push or pop that loses its CAS tries to meet an
+//   opposite operation in the elimination array. A push parks its node in
+//   a random slot for a short while; a pop that finds it takes the node
+//   and both return without touching top. Slots are tagged as well, since
+//   a taken node may be recycled and parked again by another push.
+//
+//   Allocate with automatic or static storage: C++11 operator new does
+//   not honour the over-alignment.
+class alignas(64) LockFreeStack{
+public:
+   static constexpr size_t cache_line = 64;
+   static const size_t elimination_slots = 8;
+   static const int elimination_spins = 64;   // How long a push waits in a slot
+
+   explicit LockFreeStack(bool eliminate = true);
+   ~LockFreeStack();
+
+   LockFreeStack(const LockFreeStack&) = delete;
+   LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+   void push(Thing t);
+   bool try_pop(Thing& out);
+
+   bool empty_approx() const;
+   size_t allocated_nodes() const;
+
+private:
+   struct alignas(cache_line) Slot{
+      std::atomic<TaggedPtr<StackNode>> offer;  // Node a push is waiting to hand over, or nullptr
+   };
+
+   StackNode* get_node();
+   void recycle(StackNode* node);
+   bool offer_push(StackNode* node);
+   StackNode* take_offer();
+   static size_t random_slot();
+
+   alignas(cache_line) std::atomic<TaggedPtr<StackNode>> top;
+   alignas(cache_line) std::atomic<TaggedPtr<StackNode>> free_top;
+   std::atomic<size_t> n_nodes;
+   bool eliminate;
+   Slot slots[elimination_slots];
+};
+
+#endif // LOCKFREESTACK_H
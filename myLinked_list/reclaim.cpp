@@ -0,0 +1,500 @@
+#include "reclaim.h"
+#include "slabpool.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <stdexcept>
+
+static std::atomic<uint64_t> next_serial(1);
+
+/**
+ * Serials of the domains that have not been destroyed, so a thread that
+ * exits only gives records back to domains that still exist. Created once
+ * and never freed, like the SlabPool pools, so exiting threads can always
+ * use them.
+ */
+static std::mutex &live_lock()
+{
+    static std::mutex *lock = new std::mutex;
+    return *lock;
+}
+
+static std::set<uint64_t> &live_domains()
+{
+    static std::set<uint64_t> *live = new std::set<uint64_t>;
+    return *live;
+}
+
+/**
+ * @brief RecordCache
+ * Every record this thread has claimed, plus the last few it used so that
+ * record() does not walk the list or take a lock on every call. When the
+ * thread exits, its records go back to the domains that are still alive.
+ */
+struct RecordCache{
+    struct Claim{
+        uint64_t serial;
+        ReclaimDomain *domain;
+        ReclaimDomain::Record *record;
+        Claim *next;
+    };
+
+    static const size_t size = 4;
+    uint64_t serials[size] = {};
+    ReclaimDomain::Record *records[size] = {};
+    size_t next_victim = 0;
+    Claim *claims = nullptr;
+
+    ~RecordCache();
+
+    ReclaimDomain::Record *find(uint64_t serial);
+    void add(ReclaimDomain *domain, ReclaimDomain::Record *rec);
+};
+
+RecordCache::~RecordCache()
+{
+    std::lock_guard<std::mutex> guard(live_lock());
+    while (claims != nullptr){
+        Claim *next = claims->next;
+        if (live_domains().count(claims->serial) != 0){
+            claims->domain->release_record(claims->record);
+        }
+        delete claims;
+        claims = next;
+    }
+}
+
+ReclaimDomain::Record *RecordCache::find(uint64_t serial)
+{
+    for (Claim *claim = claims; claim != nullptr; claim = claim->next){
+        if (claim->serial == serial){
+            return claim->record;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Remember a newly claimed record, dropping claims on domains that have
+ * been destroyed meanwhile so the list does not grow without bound.
+ */
+void RecordCache::add(ReclaimDomain *domain, ReclaimDomain::Record *rec)
+{
+    std::lock_guard<std::mutex> guard(live_lock());
+    Claim **link = &claims;
+    while (*link != nullptr){
+        if (live_domains().count((*link)->serial) == 0){
+            Claim *dead = *link;
+            *link = dead->next;
+            delete dead;
+        }
+        else{
+            link = &(*link)->next;
+        }
+    }
+    claims = new Claim{domain->serial, domain, rec, claims};
+}
+
+static RecordCache &record_cache()
+{
+    static thread_local RecordCache cache;
+    return cache;
+}
+
+/**
+ * @brief ReclaimDomain::ReclaimDomain
+ * Construct a domain with no thread records in use.
+ */
+ReclaimDomain::ReclaimDomain() : n_records(0), serial(next_serial.fetch_add(1)), n_orphaned(0)
+{
+    for (Record &rec : records){
+        for (std::atomic<void*> &hazard : rec.hazards){
+            hazard.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    std::lock_guard<std::mutex> guard(live_lock());
+    live_domains().insert(serial);
+}
+
+/**
+ * @brief ReclaimDomain::~ReclaimDomain
+ * Free all pending garbage. No thread may be using the domain any more.
+ */
+ReclaimDomain::~ReclaimDomain()
+{
+    {
+        std::lock_guard<std::mutex> guard(live_lock());
+        live_domains().erase(serial);
+    }
+    for (size_t i = 0; i < n_records.load(); ++i){
+        free_list(records[i].retired);
+    }
+}
+
+/**
+ * @brief ReclaimDomain::retire
+ * @param obj An object no longer reachable from the shared structure
+ * @param deleter Called with obj once no reader can be using it
+ */
+void ReclaimDomain::retire(void *obj, void (*deleter)(void *))
+{
+    Record *rec = record();
+    Retired *r = static_cast<Retired*>(SlabPool::for_size(sizeof(Retired)).allocate());
+    r->obj = obj;
+    r->deleter = deleter;
+    r->epoch = stamp();
+    r->next = rec->retired;
+    rec->retired = r;
+    ++rec->n_retired;
+    if (++rec->since_collect >= retire_batch){
+        rec->since_collect = 0;
+        adopt_orphans(rec);
+        collect(rec);
+    }
+}
+
+/**
+ * @brief ReclaimDomain::pending
+ * @return The number of objects this thread has retired that are not freed yet
+ */
+size_t ReclaimDomain::pending()
+{
+    return record()->n_retired;
+}
+
+/**
+ * What to remember about the time an object was retired. Nothing by default.
+ */
+uint64_t ReclaimDomain::stamp()
+{
+    return 0;
+}
+
+/**
+ * Find this thread's record, claiming one on first use.
+ */
+ReclaimDomain::Record *ReclaimDomain::record()
+{
+    RecordCache &cache = record_cache();
+    for (size_t i = 0; i < RecordCache::size; ++i){
+        if (cache.serials[i] == serial){
+            return cache.records[i];
+        }
+    }
+    Record *rec = cache.find(serial);
+    if (rec == nullptr){
+        rec = claim_record();
+        cache.add(this, rec);
+    }
+    size_t victim = cache.next_victim++ % RecordCache::size;
+    cache.serials[victim] = serial;
+    cache.records[victim] = rec;
+    return rec;
+}
+
+/**
+ * A record given back by an exited thread, pending garbage included, or a
+ * fresh one.
+ * @throws std::length_error if max_threads live threads already use the domain
+ */
+ReclaimDomain::Record *ReclaimDomain::claim_record()
+{
+    std::lock_guard<std::mutex> guard(claim_lock);
+    size_t n = n_records.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i){
+        if (!records[i].in_use){
+            if (records[i].retired != nullptr){
+                --n_orphaned;
+            }
+            records[i].in_use = true;
+            return &records[i];
+        }
+    }
+    if (n == max_threads){
+        throw std::length_error("too many threads for reclamation domain");
+    }
+    records[n].in_use = true;
+    n_records.store(n + 1, std::memory_order_release);
+    return &records[n];
+}
+
+/**
+ * Give back the record of a thread that is exiting. Its garbage stays on
+ * the record until another thread adopts it.
+ */
+void ReclaimDomain::release_record(Record *rec)
+{
+    std::lock_guard<std::mutex> guard(claim_lock);
+    for (std::atomic<void*> &hazard : rec->hazards){
+        hazard.store(nullptr, std::memory_order_release);
+    }
+    rec->epoch.store(0, std::memory_order_release);
+    rec->nesting = 0;
+    rec->since_collect = 0;
+    rec->in_use = false;
+    if (rec->retired != nullptr){
+        ++n_orphaned;
+    }
+}
+
+/**
+ * Move the garbage of records given back by exited threads onto rec, so
+ * it is freed by rec's owner. Skipped if another thread holds the claim lock.
+ */
+void ReclaimDomain::adopt_orphans(Record *rec)
+{
+    if (n_orphaned.load(std::memory_order_acquire) == 0){
+        return;
+    }
+    std::unique_lock<std::mutex> guard(claim_lock, std::try_to_lock);
+    if (!guard.owns_lock()){
+        return;
+    }
+    size_t n = n_records.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i){
+        Record &orphan = records[i];
+        if (!orphan.in_use && orphan.retired != nullptr){
+            rec->retired = merge_retired(rec->retired, orphan.retired);
+            rec->n_retired += orphan.n_retired;
+            orphan.retired = nullptr;
+            orphan.n_retired = 0;
+            --n_orphaned;
+        }
+    }
+}
+
+/**
+ * Merge two lists of retired entries that are each newest first into one
+ * that is newest first too, as EpochDomain::collect() expects.
+ */
+ReclaimDomain::Retired *ReclaimDomain::merge_retired(Retired *a, Retired *b)
+{
+    Retired *head = nullptr;
+    Retired **tail = &head;
+    while (a != nullptr && b != nullptr){
+        Retired *&newer = a->epoch >= b->epoch ? a : b;
+        *tail = newer;
+        tail = &newer->next;
+        newer = newer->next;
+    }
+    *tail = a != nullptr ? a : b;
+    return head;
+}
+
+/**
+ * Run the deleter of every entry on a list and free the entries.
+ * Returns how many objects were freed.
+ */
+size_t ReclaimDomain::free_list(Retired *head)
+{
+    size_t freed = 0;
+    while (head != nullptr){
+        Retired *next = head->next;
+        head->deleter(head->obj);
+        SlabPool::free(head);
+        head = next;
+        ++freed;
+    }
+    return freed;
+}
+
+/**
+ * @brief EpochDomain::EpochDomain
+ * Construct a domain at epoch 1. Epoch 0 marks a thread outside any guard.
+ */
+EpochDomain::EpochDomain() : global_epoch(1)
+{
+}
+
+/**
+ * @brief EpochDomain::~EpochDomain
+ * Free all pending garbage. No thread may be using the domain any more.
+ */
+EpochDomain::~EpochDomain()
+{
+}
+
+/**
+ * @brief EpochDomain::enter
+ * Start a critical section. Nests: only the outermost one announces the epoch.
+ */
+void EpochDomain::enter()
+{
+    Record *rec = record();
+    if (rec->nesting++ == 0){
+        rec->epoch.store(global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // The announcement must be visible before any shared pointer is read.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+/**
+ * @brief EpochDomain::leave
+ * End a critical section started with enter().
+ */
+void EpochDomain::leave()
+{
+    Record *rec = record();
+    if (--rec->nesting == 0){
+        rec->epoch.store(0, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief EpochDomain::epoch
+ * @return The current global epoch
+ */
+uint64_t EpochDomain::epoch() const
+{
+    return global_epoch.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief EpochDomain::collect
+ * Try to advance the epoch and free whatever this thread retired, or
+ * adopted from exited threads, that is now safe. Called automatically every retire_batch retires.
+ * @return The number of objects freed
+ */
+size_t EpochDomain::collect()
+{
+    Record *rec = record();
+    adopt_orphans(rec);
+    return collect(rec);
+}
+
+/**
+ * Objects retired in epoch e are safe once the global epoch reaches e + 2:
+ * every reader in a guard then entered after they were unlinked.
+ */
+size_t EpochDomain::collect(Record *rec)
+{
+    try_advance();
+    uint64_t now = global_epoch.load(std::memory_order_acquire);
+
+    // The list is newest first, so everything after the first safe entry is safe too.
+    Retired **link = &rec->retired;
+    while (*link != nullptr && (*link)->epoch + 2 > now){
+        link = &(*link)->next;
+    }
+    size_t freed = free_list(*link);
+    *link = nullptr;
+    rec->n_retired -= freed;
+    return freed;
+}
+
+/**
+ * Objects are stamped with the epoch they were retired in.
+ */
+uint64_t EpochDomain::stamp()
+{
+    return global_epoch.load(std::memory_order_acquire);
+}
+
+/**
+ * Move the global epoch on by one if every reader inside a guard has
+ * announced the current epoch.
+ */
+bool EpochDomain::try_advance()
+{
+    uint64_t now = global_epoch.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    size_t n = n_records.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i){
+        uint64_t announced = records[i].epoch.load(std::memory_order_acquire);
+        if (announced != 0 && announced != now){
+            return false;
+        }
+    }
+    return global_epoch.compare_exchange_strong(now, now + 1, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief HazardDomain::HazardDomain
+ * Construct a domain with every hazard slot empty.
+ */
+HazardDomain::HazardDomain()
+{
+}
+
+/**
+ * @brief HazardDomain::~HazardDomain
+ * Free all pending garbage. No thread may be using the domain any more.
+ */
+HazardDomain::~HazardDomain()
+{
+}
+
+/**
+ * @brief HazardDomain::clear
+ * @param i
+ * Empty hazard slot i. The pointer it held may be freed from now on.
+ */
+void HazardDomain::clear(size_t i)
+{
+    record()->hazards[i].store(nullptr, std::memory_order_release);
+}
+
+/**
+ * @brief HazardDomain::clear_all
+ * Empty all of this thread's hazard slots.
+ */
+void HazardDomain::clear_all()
+{
+    Record *rec = record();
+    for (std::atomic<void*> &hazard : rec->hazards){
+        hazard.store(nullptr, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief HazardDomain::collect
+ * Free whatever this thread retired, or adopted from exited threads, that
+ * no hazard slot holds. Called
+ * automatically every retire_batch retires.
+ * @return The number of objects freed
+ */
+size_t HazardDomain::collect()
+{
+    Record *rec = record();
+    adopt_orphans(rec);
+    return collect(rec);
+}
+
+/**
+ * Snapshot every hazard slot, sort the snapshot and free each retired
+ * object that is not in it.
+ */
+size_t HazardDomain::collect(Record *rec)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    size_t n = n_records.load(std::memory_order_acquire);
+    void **hazards = new void*[n * hazards_per_thread];
+    size_t n_hazards = 0;
+    for (size_t i = 0; i < n; ++i){
+        for (std::atomic<void*> &hazard : records[i].hazards){
+            void *ptr = hazard.load(std::memory_order_acquire);
+            if (ptr != nullptr){
+                hazards[n_hazards++] = ptr;
+            }
+        }
+    }
+    std::sort(hazards, hazards + n_hazards, std::less<void*>());
+
+    Retired *keep = nullptr;
+    Retired *free_now = nullptr;
+    Retired *curr = rec->retired;
+    while (curr != nullptr){
+        Retired *next = curr->next;
+        Retired *&into = std::binary_search(hazards, hazards + n_hazards, curr->obj, std::less<void*>()) ? keep : free_now;
+        curr->next = into;
+        into = curr;
+        curr = next;
+    }
+    delete [] hazards;
+
+    size_t freed = free_list(free_now);
+    rec->retired = keep;
+    rec->n_retired -= freed;
+    return freed;
+}
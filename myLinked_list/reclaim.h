@@ -0,0 +1,163 @@
+#ifndef RECLAIM_H
+#define RECLAIM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Safe memory reclamation for concurrent containers.
+//
+//   A node unlinked from a shared structure may still be in use by readers
+//   that found it earlier, so instead of deleting it the remover retires it
+//   to a domain, which deletes it once no reader can hold it any more.
+//
+//   EpochDomain: readers announce the global epoch while inside a Guard.
+//   Retired nodes are freed in batches once the epoch has moved on twice.
+//   Reads cost two stores per critical section, but one stalled reader
+//   holds back every free.
+//
+//   HazardDomain: readers publish each pointer they are about to use in a
+//   hazard slot. Retired nodes are freed once no slot holds them, so the
+//   garbage per thread stays bounded even if a reader stalls, at the cost
+//   of a store and a fence per pointer read.
+//
+//   Each thread gets a record in the domain the first time it uses it and
+//   gives it back when the thread exits, so max_threads only limits threads
+//   using the domain at the same time. Garbage a thread leaves behind is
+//   adopted by the next thread that collects or claims its record.
+//
+//   Allocate domains with automatic or static storage: C++11 operator new
+//   does not honour the over-alignment of the records.
+
+// Deleter that destroys and frees obj with its class' operator delete,
+//   so a retired Link goes back through Link::operator delete.
+template<class T>
+void delete_object(void* obj)
+{
+    delete static_cast<T*>(obj);
+}
+
+class ReclaimDomain{
+public:
+   static const size_t max_threads = 128;
+   static const size_t hazards_per_thread = 4;
+   static const size_t retire_batch = 64;   // Retires between attempts to free
+
+   ReclaimDomain(const ReclaimDomain&) = delete;
+   ReclaimDomain& operator=(const ReclaimDomain&) = delete;
+
+   template<class T>
+   void retire(T* obj){ retire(obj, &delete_object<T>); }
+   void retire(void* obj, void (*deleter)(void*));
+
+   size_t pending();
+
+protected:
+   struct Retired{
+      void *obj;
+      void (*deleter)(void*);
+      uint64_t epoch;             // Global epoch when retired, EpochDomain only
+      Retired *next;
+   };
+
+   struct alignas(64) Record{
+      std::atomic<uint64_t> epoch{0};          // Epoch announced by a reader, 0 outside guards
+      std::atomic<void*> hazards[hazards_per_thread];
+      unsigned nesting = 0;                    // Guards held by the owner
+      Retired *retired = nullptr;              // Owner's garbage, newest first
+      size_t n_retired = 0;
+      size_t since_collect = 0;
+      bool in_use = false;                     // Claimed by a live thread, guarded by claim_lock
+   };
+
+   ReclaimDomain();
+   virtual ~ReclaimDomain();
+
+   Record* record();
+   virtual uint64_t stamp();
+   virtual size_t collect(Record* rec) = 0;
+   static size_t free_list(Retired* head);
+   static Retired* merge_retired(Retired* a, Retired* b);
+   void adopt_orphans(Record* rec);
+
+   Record records[max_threads];
+   std::atomic<size_t> n_records;   // Records handed out, all below this index
+
+private:
+   friend struct RecordCache;
+
+   Record* claim_record();
+   void release_record(Record* rec);
+
+   uint64_t serial;                 // Tells domains apart in the thread local caches
+   std::mutex claim_lock;
+   std::atomic<size_t> n_orphaned;  // Released records still holding garbage
+};
+
+
+class EpochDomain : public ReclaimDomain{
+public:
+   // Critical section: nodes reachable during it are not freed before it ends.
+   class Guard{
+   public:
+      explicit Guard(EpochDomain& domain) : domain(domain){ domain.enter(); }
+      ~Guard(){ domain.leave(); }
+
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+   private:
+      EpochDomain &domain;
+   };
+
+   EpochDomain();
+   ~EpochDomain();
+
+   void enter();
+   void leave();
+
+   uint64_t epoch() const;
+   size_t collect();
+
+protected:
+   uint64_t stamp() override;
+   size_t collect(Record* rec) override;
+
+private:
+   bool try_advance();
+
+   alignas(64) std::atomic<uint64_t> global_epoch;
+};
+
+
+class HazardDomain : public ReclaimDomain{
+public:
+   HazardDomain();
+   ~HazardDomain();
+
+   // Load src into hazard slot i and return it once the published value is
+   //   known to still be current, so it cannot be freed until clear(i).
+   template<class T>
+   T* protect(size_t i, const std::atomic<T*>& src){
+       std::atomic<void*> &slot = record()->hazards[i];
+       T *ptr = src.load(std::memory_order_relaxed);
+       for (;;){
+           slot.store(ptr, std::memory_order_seq_cst);
+           T *again = src.load(std::memory_order_acquire);
+           if (again == ptr){
+               return ptr;
+           }
+           ptr = again;
+       }
+   }
+
+   void clear(size_t i);
+   void clear_all();
+   size_t collect();
+
+protected:
+   size_t collect(Record* rec) override;
+};
+
+#endif // RECLAIM_H
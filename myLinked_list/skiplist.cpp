@@ -0,0 +1,292 @@
+#include "skiplist.h"
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief SkipListIterator::operator*
+ * @return Return a reference to the thing in the node that we're pointing to
+ */
+Thing &SkipListIterator::operator*()
+{
+    return ptr->value;
+}
+
+/**
+ * @brief SkipListIterator::operator++
+ * Make the current iterator point to the next node in the list.
+ * @return Return a reference to this object.
+ */
+SkipListIterator &SkipListIterator::operator++()
+{
+    ptr = ptr->levels()[0].next;
+    return *this;
+}
+
+/**
+ * @brief SkipList::SkipList
+ * Construct an empty list, which is just the head tower.
+ */
+SkipList::SkipList() : head(make_node(Thing(), max_level))
+{
+}
+
+/**
+ * @brief SkipList::~SkipList
+ * Free every tower, including the head.
+ */
+SkipList::~SkipList()
+{
+    clear();
+    free_node(head);
+}
+
+/**
+ * @brief SkipList::insert
+ * @param t
+ * Insert t after every item with the same key.
+ */
+void SkipList::insert(Thing t)
+{
+    SkipNode *update[max_level];
+    size_t rank[max_level];
+
+    SkipNode *x = head;
+    for (int k = level - 1; k >= 0; --k){
+        rank[k] = k == level - 1 ? 0 : rank[k + 1];
+        while (x->levels()[k].next != nullptr && x->levels()[k].next->value.i <= t.i){
+            rank[k] += x->levels()[k].span;
+            x = x->levels()[k].next;
+        }
+        update[k] = x;
+    }
+
+    int height = random_level();
+    if (height > level){
+        for (int k = level; k < height; ++k){
+            rank[k] = 0;
+            update[k] = head;
+            head->levels()[k].span = count;
+        }
+        level = height;
+    }
+
+    SkipNode *node = make_node(t, height);
+    for (int k = 0; k < height; ++k){
+        SkipNode::Level &before = update[k]->levels()[k];
+        node->levels()[k].next = before.next;
+        node->levels()[k].span = before.span - (rank[0] - rank[k]);
+        before.next = node;
+        before.span = rank[0] - rank[k] + 1;
+    }
+    for (int k = height; k < level; ++k){
+        ++update[k]->levels()[k].span;
+    }
+    ++count;
+}
+
+/**
+ * @brief SkipList::erase
+ * @param t
+ * @return true if an item equal to t was found and removed
+ */
+bool SkipList::erase(Thing t)
+{
+    SkipNode *update[max_level];
+    SkipNode *x = head;
+    for (int k = level - 1; k >= 0; --k){
+        while (x->levels()[k].next != nullptr && x->levels()[k].next->value.i < t.i){
+            x = x->levels()[k].next;
+        }
+        update[k] = x;
+    }
+
+    x = x->levels()[0].next;
+    if (x == nullptr || !(x->value == t)){
+        return false;
+    }
+    for (int k = 0; k < level; ++k){
+        SkipNode::Level &before = update[k]->levels()[k];
+        if (before.next == x){
+            before.span += x->levels()[k].span - 1;
+            before.next = x->levels()[k].next;
+        }
+        else{
+            --before.span;
+        }
+    }
+    while (level > 1 && head->levels()[level - 1].next == nullptr){
+        head->levels()[level - 1].span = 0;
+        --level;
+    }
+    free_node(x);
+    --count;
+    return true;
+}
+
+/**
+ * @brief SkipList::find
+ * @param t
+ * @return A pointer to the first item equal to t, or nullptr
+ */
+Thing *SkipList::find(Thing t)
+{
+    SkipNode *x = head;
+    for (int k = level - 1; k >= 0; --k){
+        while (x->levels()[k].next != nullptr && x->levels()[k].next->value.i < t.i){
+            x = x->levels()[k].next;
+        }
+    }
+    x = x->levels()[0].next;
+    if (x == nullptr || !(x->value == t)){
+        return nullptr;
+    }
+    return &x->value;
+}
+
+/**
+ * @brief SkipList::contains
+ * @param t
+ * @return true if an item equal to t is in the list
+ */
+bool SkipList::contains(Thing t)
+{
+    return find(t) != nullptr;
+}
+
+/**
+ * @brief SkipList::at
+ * @param i
+ * @return A reference to the item at index i, in sorted order
+ * @throws std::out_of_range("i out of bounds")
+ */
+Thing &SkipList::at(size_t i)
+{
+    if (i >= count){
+        throw std::out_of_range("i out of bounds");
+    }
+    size_t target = i + 1;   // The head is position 0
+    size_t traversed = 0;
+    SkipNode *x = head;
+    for (int k = level - 1; k >= 0; --k){
+        while (x->levels()[k].next != nullptr && traversed + x->levels()[k].span <= target){
+            traversed += x->levels()[k].span;
+            x = x->levels()[k].next;
+        }
+        if (traversed == target){
+            break;
+        }
+    }
+    return x->value;
+}
+
+/**
+ * @brief SkipList::size
+ * @return number of items in the list
+ */
+size_t SkipList::size()
+{
+    return count;
+}
+
+/**
+ * @brief SkipList::empty
+ * @return true if there are no items in the list
+ */
+bool SkipList::empty()
+{
+    return count == 0;
+}
+
+/**
+ * @brief SkipList::levels
+ * @return The height of the tallest tower
+ */
+int SkipList::levels()
+{
+    return level;
+}
+
+/**
+ * @brief SkipList::begin
+ * @return an iterator referencing the smallest item
+ */
+SkipListIterator SkipList::begin()
+{
+    SkipListIterator iter;
+    iter.ptr = head->levels()[0].next;
+    return iter;
+}
+
+/**
+ * @brief SkipList::end
+ * @return an iterator representing one past the largest item
+ */
+SkipListIterator SkipList::end()
+{
+    return SkipListIterator();
+}
+
+/**
+ * @brief SkipList::clear
+ * Free every tower except the head.
+ */
+void SkipList::clear()
+{
+    SkipNode *curr = head->levels()[0].next;
+    while (curr != nullptr){
+        SkipNode *next = curr->levels()[0].next;
+        free_node(curr);
+        curr = next;
+    }
+    for (int k = 0; k < max_level; ++k){
+        head->levels()[k].next = nullptr;
+        head->levels()[k].span = 0;
+    }
+    level = 1;
+    count = 0;
+}
+
+/**
+ * Allocate a tower of height levels as one block: the node followed by its levels.
+ */
+SkipNode *SkipList::make_node(Thing t, int height)
+{
+    static_assert(sizeof(SkipNode) % alignof(SkipNode::Level) == 0, "levels must start aligned after the node");
+    void *raw = std::malloc(sizeof(SkipNode) + height * sizeof(SkipNode::Level));
+    if (raw == nullptr){
+        throw std::bad_alloc();
+    }
+    SkipNode *node = new (raw) SkipNode;
+    node->value = t;
+    node->height = height;
+    for (int k = 0; k < height; ++k){
+        node->levels()[k].next = nullptr;
+        node->levels()[k].span = 0;
+    }
+    return node;
+}
+
+void SkipList::free_node(SkipNode *node)
+{
+    std::free(node);
+}
+
+/**
+ * Height for a new tower: each extra level with probability 1/4.
+ * Uses a xorshift generator so insert does not depend on rand().
+ */
+int SkipList::random_level()
+{
+    int height = 1;
+    while (height < max_level){
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if ((seed & 3) != 0){
+            break;
+        }
+        ++height;
+    }
+    return height;
+}
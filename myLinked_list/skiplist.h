@@ -0,0 +1,79 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <cstdint>
+#include "linkedlist.h"
+
+// One tower of a SkipList. The header is followed, in the same
+//   allocation, by height SkipLevel entries; levels()[0] is the plain
+//   linked list through every node.
+struct SkipNode{
+   // Forward link on one level and how many positions it skips.
+   struct Level{
+      SkipNode *next;
+      size_t span;
+   };
+
+   Thing value;
+   int height;
+
+   Level* levels(){ return reinterpret_cast<Level*>(this + 1); }
+};
+
+
+// Iterator for SkipList, walks the bottom level
+class SkipListIterator{
+public:
+   SkipNode *ptr = nullptr; // Points to the current node
+
+   Thing& operator*();             // Dereference
+   SkipListIterator& operator++(); // Increment
+
+   bool operator !=(const SkipListIterator& other) const{
+       return ptr != other.ptr;
+   }
+};
+
+
+// Sorted list of Things (by Thing::i, duplicates allowed) with
+//   O(log n) expected insert, find, erase and at(i).
+//   Every node gets a random height, each level up having a quarter of the
+//   nodes of the one below. Each forward link stores the number of positions
+//   it skips, so at(i) adds up spans on the way down instead of counting nodes.
+class SkipList{
+public:
+   static const int max_level = 16;
+
+   SkipList();
+   ~SkipList();
+
+   SkipList(const SkipList&) = delete;
+   SkipList& operator=(const SkipList&) = delete;
+
+   void insert(Thing t);
+   bool erase(Thing t);
+   Thing* find(Thing t);
+   bool contains(Thing t);
+
+   Thing& at(size_t i);
+   size_t size();
+   bool empty();
+   int levels();
+
+   SkipListIterator begin();
+   SkipListIterator end();
+
+   void clear();
+
+private:
+   static SkipNode* make_node(Thing t, int height);
+   static void free_node(SkipNode* node);
+   int random_level();
+
+   SkipNode *head;     // Tower of max_level levels, holds no item
+   int level = 1;      // Levels in use
+   size_t count = 0;
+   uint32_t seed = 0x9E3779B9u;
+};
+
+#endif // SKIPLIST_H
@@ -0,0 +1,394 @@
+#include "slabpool.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static const size_t n_pools = SlabPool::max_object_size / 16;
+
+// Slab header rounded up to a cache line, objects start right after it.
+static size_t header_size()
+{
+    return 64;
+}
+
+/**
+ * @brief SlabPool::ThreadCache
+ * Per thread lists of free objects, one per pool. Whatever is left when the
+ * thread exits goes back to the pools.
+ */
+struct SlabPool::ThreadCache{
+    FreeObject *heads[n_pools] = {};
+    size_t counts[n_pools] = {};
+
+    ~ThreadCache();
+};
+
+// Set once this thread's cache is destroyed. Other thread_local destructors
+//   may still allocate or free after that, e.g. a thread_local list; they go
+//   straight to the pools. A bool has no destructor, so it stays readable
+//   until the thread is gone.
+static thread_local bool thread_cache_gone = false;
+
+SlabPool::ThreadCache::~ThreadCache()
+{
+    thread_cache_gone = true;
+    for (size_t i = 0; i < n_pools; ++i){
+        if (heads[i] != nullptr){
+            SlabPool::pools()[i]->release(heads[i]);
+            heads[i] = nullptr;
+            counts[i] = 0;
+        }
+    }
+}
+
+/**
+ * @brief SlabPool::for_size
+ * @param object_size
+ * @return The pool for objects of object_size bytes
+ * @throws std::invalid_argument if object_size is larger than max_object_size
+ */
+SlabPool &SlabPool::for_size(size_t object_size)
+{
+    if (object_size > max_object_size){
+        throw std::invalid_argument("object too large for SlabPool");
+    }
+    if (object_size == 0){
+        object_size = 1;
+    }
+    return *pools()[(object_size + 15) / 16 - 1];
+}
+
+/**
+ * @brief SlabPool::free
+ * @param ptr An object from any pool's allocate(), may be nullptr
+ * Return ptr to the pool it came from.
+ */
+void SlabPool::free(void *ptr)
+{
+    if (ptr != nullptr){
+        slab_of(ptr)->pool->deallocate(ptr);
+    }
+}
+
+/**
+ * @brief SlabPool::allocate
+ * @return Uninitialised memory for one object, 16 byte aligned
+ */
+void *SlabPool::allocate()
+{
+    ThreadCache *cache = thread_cache();
+    if (cache == nullptr){
+        std::lock_guard<std::mutex> guard(lock);
+        return take_object();
+    }
+    FreeObject *obj = cache->heads[id];
+    if (obj == nullptr){
+        cache->counts[id] = refill(cache->heads[id]);
+        obj = cache->heads[id];
+    }
+    cache->heads[id] = obj->next;
+    --cache->counts[id];
+    return obj;
+}
+
+/**
+ * @brief SlabPool::allocate_n
+ * @param out Receives n objects
+ * @param n
+ * Allocate n objects at once: first from this thread's cache, then the rest
+ * straight from the slabs under a single lock. Objects carved from a fresh
+ * slab are adjacent in memory. Each is freed on its own, as usual.
+ * @throws std::bad_alloc if a slab is needed and cannot be allocated; the
+ * objects already taken are given back first, so the caller owns none.
+ */
+void SlabPool::allocate_n(void **out, size_t n)
+{
+    ThreadCache *cache = thread_cache();
+    size_t i = 0;
+    for (; cache != nullptr && i < n && cache->heads[id] != nullptr; ++i){
+        out[i] = cache->heads[id];
+        cache->heads[id] = cache->heads[id]->next;
+        --cache->counts[id];
+    }
+    if (i == n){
+        return;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    try{
+        for (; i < n; ++i){
+            out[i] = take_object();
+        }
+    }
+    catch (...){
+        FreeObject *taken = nullptr;
+        while (i > 0){
+            FreeObject *obj = static_cast<FreeObject*>(out[--i]);
+            obj->next = taken;
+            taken = obj;
+        }
+        put_back(taken);
+        throw;
+    }
+}
+
+/**
+ * @brief SlabPool::deallocate
+ * @param ptr An object from this pool's allocate()
+ * The object goes to this thread's cache. Once the cache holds two batches,
+ * one batch is handed back to the slabs. After the cache is destroyed at
+ * thread exit, the object goes straight back to its slab.
+ */
+void SlabPool::deallocate(void *ptr)
+{
+    ThreadCache *cache = thread_cache();
+    FreeObject *obj = static_cast<FreeObject*>(ptr);
+    if (cache == nullptr){
+        obj->next = nullptr;
+        release(obj);
+        return;
+    }
+    obj->next = cache->heads[id];
+    cache->heads[id] = obj;
+    if (++cache->counts[id] < 2 * batch_size){
+        return;
+    }
+
+    FreeObject *last = obj;
+    for (size_t i = 1; i < batch_size; ++i){
+        last = last->next;
+    }
+    cache->heads[id] = last->next;
+    cache->counts[id] -= batch_size;
+    last->next = nullptr;
+    release(obj);
+}
+
+/**
+ * @brief SlabPool::flush_thread_cache
+ * Hand every object cached by this thread back to the slabs, so that
+ * empty slabs can be freed.
+ */
+void SlabPool::flush_thread_cache()
+{
+    ThreadCache *cache = thread_cache();
+    if (cache != nullptr && cache->heads[id] != nullptr){
+        release(cache->heads[id]);
+        cache->heads[id] = nullptr;
+        cache->counts[id] = 0;
+    }
+}
+
+/**
+ * @brief SlabPool::object_size
+ * @return The size of each object in bytes
+ */
+size_t SlabPool::object_size() const
+{
+    return size;
+}
+
+/**
+ * @brief SlabPool::slab_count
+ * @return The number of slabs currently allocated by this pool
+ */
+size_t SlabPool::slab_count()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return n_slabs;
+}
+
+SlabPool::SlabPool(size_t object_size, size_t id)
+    : size((object_size + 15) / 16 * 16), id(id),
+      per_slab((slab_size - header_size()) / size)
+{
+    static_assert(sizeof(Slab) <= 64, "slab header must fit in header_size()");
+}
+
+/**
+ * Every pool, indexed by size class. Created once and never freed, so
+ * thread caches can still flush into them while the program exits.
+ */
+SlabPool **SlabPool::pools()
+{
+    static SlabPool** all = []{
+        SlabPool** created = new SlabPool*[n_pools];
+        for (size_t i = 0; i < n_pools; ++i){
+            created[i] = new SlabPool((i + 1) * 16, i);
+        }
+        return created;
+    }();
+    return all;
+}
+
+/**
+ * Slabs are aligned to slab_size, so masking an object's address gives its slab.
+ */
+SlabPool::Slab *SlabPool::slab_of(void *ptr)
+{
+    return reinterpret_cast<Slab*>(reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t(slab_size - 1));
+}
+
+/**
+ * This thread's cache, or nullptr once it has been destroyed at thread exit.
+ */
+SlabPool::ThreadCache *SlabPool::thread_cache()
+{
+    if (thread_cache_gone){
+        return nullptr;
+    }
+    static thread_local ThreadCache cache;
+    return &cache;
+}
+
+/**
+ * Take up to batch_size objects from the slabs and chain them onto head.
+ * Returns how many were taken, fewer if a new slab could not be allocated
+ * partway. Throws std::bad_alloc only if none could be taken.
+ */
+size_t SlabPool::refill(FreeObject *&head)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    size_t taken = 0;
+    try{
+        for (; taken < batch_size; ++taken){
+            FreeObject *obj = take_object();
+            obj->next = head;
+            head = obj;
+        }
+    }
+    catch (const std::bad_alloc&){
+        if (taken == 0){
+            throw;
+        }
+    }
+    return taken;
+}
+
+/**
+ * Take one object from the first slab that has any, making a new slab if
+ * none does. The pool lock must be held.
+ */
+SlabPool::FreeObject *SlabPool::take_object()
+{
+    Slab *slab = available;
+    if (slab == nullptr){
+        slab = new_slab();
+        list_slab(slab);
+    }
+
+    FreeObject *obj = slab->free_list;
+    if (obj != nullptr){
+        slab->free_list = obj->next;
+    }
+    else{
+        char *first = reinterpret_cast<char*>(slab) + header_size();
+        obj = reinterpret_cast<FreeObject*>(first + slab->carved * size);
+        ++slab->carved;
+    }
+    if (slab->in_use++ == 0){
+        --n_empty;
+    }
+    if (slab->free_list == nullptr && slab->carved == per_slab){
+        unlist_slab(slab);
+    }
+    return obj;
+}
+
+/**
+ * Put a nullptr terminated chain of objects back on their slabs' free lists.
+ * Slabs that become empty are freed, except for one spare.
+ */
+void SlabPool::release(FreeObject *head)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    put_back(head);
+}
+
+/**
+ * release() for callers that already hold the pool lock.
+ */
+void SlabPool::put_back(FreeObject *head)
+{
+    while (head != nullptr){
+        FreeObject *obj = head;
+        head = head->next;
+
+        Slab *slab = slab_of(obj);
+        obj->next = slab->free_list;
+        slab->free_list = obj;
+        if (!slab->listed){
+            list_slab(slab);
+        }
+        if (--slab->in_use == 0 && ++n_empty > 1){
+            unlist_slab(slab);
+            --n_empty;
+            --n_slabs;
+#ifdef _WIN32
+            _aligned_free(slab);
+#else
+            std::free(slab);
+#endif
+        }
+    }
+}
+
+/**
+ * Allocate an empty slab_size aligned slab.
+ */
+SlabPool::Slab *SlabPool::new_slab()
+{
+#ifdef _WIN32
+    void *raw = _aligned_malloc(slab_size, slab_size);
+    if (raw == nullptr){
+        throw std::bad_alloc();
+    }
+#else
+    void *raw = nullptr;
+    if (posix_memalign(&raw, slab_size, slab_size) != 0){
+        throw std::bad_alloc();
+    }
+#endif
+    Slab *slab = new (raw) Slab;
+    slab->pool = this;
+    ++n_slabs;
+    ++n_empty;
+    return slab;
+}
+
+/**
+ * Add slab to the front of the list of slabs with objects to hand out.
+ */
+void SlabPool::list_slab(Slab *slab)
+{
+    slab->prev = nullptr;
+    slab->next = available;
+    if (available != nullptr){
+        available->prev = slab;
+    }
+    available = slab;
+    slab->listed = true;
+}
+
+/**
+ * Remove slab from the list of slabs with objects to hand out.
+ */
+void SlabPool::unlist_slab(Slab *slab)
+{
+    if (slab->prev != nullptr){
+        slab->prev->next = slab->next;
+    }
+    else{
+        available = slab->next;
+    }
+    if (slab->next != nullptr){
+        slab->next->prev = slab->prev;
+    }
+    slab->listed = false;
+}
+
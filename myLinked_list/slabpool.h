@@ -0,0 +1,81 @@
+#ifndef SLABPOOL_H
+#define SLABPOOL_H
+
+#include <cstddef>
+#include <mutex>
+
+// Fixed size object allocator for small nodes such as Link.
+//
+//   Objects are carved from 64 KB slabs. A slab is aligned to its own size,
+//   so the slab an object came from is found by masking its address, and
+//   free objects are kept on an intrusive list threaded through themselves.
+//
+//   Each thread keeps a small cache of free objects per pool, so most
+//   allocations and frees touch no shared state. A thread only takes the
+//   pool lock to refill its cache or to return a batch of objects, and a
+//   slab that becomes completely free is given back to the system (one
+//   empty slab is kept to avoid thrashing). Once a thread's cache has been
+//   destroyed at exit, that thread allocates and frees under the pool lock.
+//
+//   There is one pool per 16 byte size class up to max_object_size. Pools
+//   are never destroyed, so objects may be freed at any time, by any thread.
+class SlabPool{
+public:
+   static const size_t slab_size = 64 * 1024;
+   static const size_t max_object_size = 256;
+   static const size_t batch_size = 32;   // Objects moved per refill/flush
+
+   static SlabPool& for_size(size_t object_size);
+   static void free(void* ptr);
+
+   void* allocate();
+   void allocate_n(void** out, size_t n);
+   void deallocate(void* ptr);
+
+   void flush_thread_cache();
+
+   size_t object_size() const;
+   size_t slab_count();
+
+private:
+   struct FreeObject{
+      FreeObject *next;
+   };
+
+   struct Slab{
+      SlabPool *pool;
+      Slab *prev = nullptr;       // Neighbours in the pool's list of slabs with free objects
+      Slab *next = nullptr;
+      FreeObject *free_list = nullptr;
+      size_t carved = 0;          // Objects handed out from the untouched end of the slab
+      size_t in_use = 0;          // Objects held by users or thread caches
+      bool listed = false;
+   };
+
+   struct ThreadCache;
+
+   SlabPool(size_t object_size, size_t id);
+
+   static SlabPool** pools();
+   static Slab* slab_of(void* ptr);
+   static ThreadCache* thread_cache();
+
+   size_t refill(FreeObject*& head);
+   FreeObject* take_object();
+   void release(FreeObject* head);
+   void put_back(FreeObject* head);
+   Slab* new_slab();
+   void list_slab(Slab* slab);
+   void unlist_slab(Slab* slab);
+
+   size_t size;                 // Object size, a multiple of 16
+   size_t id;                   // Index of this pool's entry in each thread cache
+   size_t per_slab;             // Objects that fit in one slab
+
+   std::mutex lock;             // Guards everything below
+   Slab *available = nullptr;   // Slabs that still have free or uncarved objects
+   size_t n_slabs = 0;
+   size_t n_empty = 0;          // Slabs with no objects in use
+};
+
+#endif // SLABPOOL_H
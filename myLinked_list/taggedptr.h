@@ -0,0 +1,38 @@
+#ifndef TAGGEDPTR_H
+#define TAGGEDPTR_H
+
+#include <cstdint>
+
+// Pointer and 16 bit version tag packed into one 64 bit word, so both
+//   can be swapped with a single compare-and-swap. x86-64 and AArch64
+//   user space addresses fit in the low 48 bits; the tag lives above them.
+//
+//   Lock-free structures bump the tag on every successful CAS. A thread
+//   that read the word, stalled, and then sees the same pointer again
+//   still fails its CAS because the tag moved on (the ABA problem), unless
+//   exactly a multiple of 65536 updates happened in between.
+template<class T>
+class TaggedPtr{
+public:
+   static const uint64_t ptr_mask = (uint64_t(1) << 48) - 1;
+
+   TaggedPtr() : bits(0){}
+   TaggedPtr(T* ptr, uint16_t tag)
+       : bits((uint64_t(reinterpret_cast<uintptr_t>(ptr)) & ptr_mask) | (uint64_t(tag) << 48)){}
+
+   T* ptr() const{ return reinterpret_cast<T*>(uintptr_t(bits & ptr_mask)); }
+   uint16_t tag() const{ return uint16_t(bits >> 48); }
+
+   // The word to CAS in when replacing this one with ptr.
+   TaggedPtr successor(T* ptr) const{ return TaggedPtr(ptr, uint16_t(tag() + 1)); }
+
+   bool operator==(const TaggedPtr& other) const{ return bits == other.bits; }
+   bool operator!=(const TaggedPtr& other) const{ return bits != other.bits; }
+
+private:
+   static_assert(sizeof(void*) == 8, "TaggedPtr needs 64 bit pointers");
+
+   uint64_t bits;
+};
+
+#endif // TAGGEDPTR_H
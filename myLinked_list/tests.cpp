@@ -4,6 +4,26 @@
 #include <map>
 #include <deque>
 #include "linkedlist.h"
+#include "dlist.h"
+#include "slabpool.h"
+#include "linkarena.h"
+#include "unrolledlist.h"
+#include "intrusivelist.h"
+#include "compactlist.h"
+#include "skiplist.h"
+#include "lockfreestack.h"
+#include "lockfreequeue.h"
+#include "reclaim.h"
+#include "lazylist.h"
+#include "conslist.h"
+#include "traversal.h"
+#include "../myBST/tree.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
 
 #include <iostream>
 
@@ -23,6 +43,7 @@ Link* last_alloc = nullptr;
 
 deque<Link*> allocated_links;
 bool track_links = false;
+int fail_link_alloc_in = 0;   // When above 0, the allocation that brings it to 0 throws
 
 pair<LinkedList*, deque<Link*>> get_list(int sz = 0){
     // Return heap allocate to allow for a memory leak
@@ -38,6 +59,9 @@ pair<LinkedList*, deque<Link*>> get_list(int sz = 0){
 }
 
 void* Link::operator new(size_t sz){
+    if(fail_link_alloc_in > 0 && --fail_link_alloc_in == 0){
+        throw std::bad_alloc();
+    }
     last_alloc  = ::new Link(sz);
     still_allocated[last_alloc] = true;
     ++n_allocated_links;
@@ -51,6 +75,21 @@ void Link::operator delete(void* ptr){
     --n_allocated_links;
 }
 
+void Link::allocate_n(Link** out, size_t k){
+    size_t i = 0;
+    try{
+        for(; i < k; ++i){
+            out[i] = static_cast<Link*>(Link::operator new(sizeof(Link)));
+        }
+    }
+    catch(...){
+        while(i > 0){
+            Link::operator delete(out[--i]);
+        }
+        throw;
+    }
+}
+
 TEST_CASE("0-Constructor", "[0]"){
     LinkedList ll;
     REQUIRE(ll.head == nullptr);
@@ -663,3 +702,1561 @@ TEST_CASE("15-destructor", "[15]"){
 
 
 
+
+TEST_CASE("16-cached-tail-and-size", "[16]"){
+    GIVEN("A list built with push_back"){
+        LinkedList myList;
+        int n = 1000;
+        for(int i = 0; i < n; ++i){
+            myList.push_back(Thing(i));
+            UNSCOPED_INFO("back and size should follow every push_back");
+            REQUIRE(myList.back().i == i);
+            REQUIRE(myList.size() == static_cast<size_t>(i+1));
+        }
+        WHEN("mixing operations at both ends"){
+            myList.pop_back();
+            myList.pop_front();
+            myList.push_front(Thing(-1));
+            REQUIRE(myList.size() == static_cast<size_t>(n-1));
+            REQUIRE(myList.front().i == -1);
+            REQUIRE(myList.back().i == n-2);
+            myList.reverse();
+            REQUIRE(myList.back().i == -1);
+            myList.push_back(Thing(42));
+            REQUIRE(myList.get_link(n-1)->value.i == 42);
+            REQUIRE_THROWS(myList.at(n));
+        }
+        WHEN("head is rewired from outside the list"){
+            Link* second = myList.head->next;
+            myList.head->next = nullptr;
+            Link* first = myList.head;
+            myList.head = second;
+            delete first;
+            REQUIRE(myList.size() == static_cast<size_t>(n-1));
+            REQUIRE(myList.back().i == n-1);
+        }
+        WHEN("links are added after the tail from outside the list"){
+            myList.size();
+            Link* last = myList.head;
+            while(last->next != nullptr) last = last->next;
+            last->next = new Link(Thing(100));
+            REQUIRE(myList.size() == static_cast<size_t>(n+1));
+            REQUIRE(myList.back().i == 100);
+            myList.push_back(Thing(101));
+            REQUIRE(myList.at(n+1).i == 101);
+        }
+        WHEN("every link, tail included, is freed and head replaced from outside"){
+            myList.size();
+            while(myList.head != nullptr){
+                Link* next = myList.head->next;
+                delete myList.head;
+                myList.head = next;
+            }
+            myList.head = new Link(Thing(5));
+            REQUIRE(myList.size() == 1);
+            REQUIRE(myList.back().i == 5);
+        }
+        WHEN("the list is cut short from outside and resync() is called"){
+            myList.size();
+            Link* cut = myList.head->next->next;
+            myList.head->next->next = nullptr;
+            while(cut != nullptr){
+                Link* next = cut->next;
+                delete cut;
+                cut = next;
+            }
+            myList.resync();
+            REQUIRE(myList.size() == 2);
+            REQUIRE(myList.back().i == myList.head->next->value.i);
+            myList.push_back(Thing(7));
+            REQUIRE(myList.at(2).i == 7);
+            REQUIRE(myList.size() == 3);
+        }
+    }
+}
+
+TEST_CASE("17-dlist", "[17]"){
+    GIVEN("A doubly linked list with n items in it."){
+        auto link_counter = n_allocated_links;
+        DList myList;
+        int n = 20;
+        for(int i = 0; i < n; ++i){
+            myList.push_back(Thing(i));
+        }
+        UNSCOPED_INFO("DLinks should not go through Link::operator new");
+        REQUIRE(n_allocated_links == link_counter);
+        REQUIRE(myList.size() == static_cast<size_t>(n));
+
+        THEN("it can be walked in both directions"){
+            int i = 0;
+            for(DListIterator it = myList.begin(); it != myList.end(); ++it){
+                REQUIRE((*it).i == i++);
+            }
+            DListIterator it = myList.end();
+            for(int j = n-1; j >= 0; --j){
+                --it;
+                REQUIRE((*it).i == j);
+            }
+            REQUIRE(it == myList.begin());
+        }
+        WHEN("popping from both ends"){
+            myList.pop_back();
+            myList.pop_front();
+            REQUIRE(myList.front().i == 1);
+            REQUIRE(myList.back().i == n-2);
+            REQUIRE(myList.size() == static_cast<size_t>(n-2));
+        }
+        WHEN("inserting and erasing in the middle"){
+            DListIterator it = myList.begin();
+            ++it; ++it;
+            it = myList.erase(it);
+            REQUIRE((*it).i == 3);
+            it = myList.insert(it, Thing(42));
+            --it;
+            REQUIRE((*it).i == 1);
+            REQUIRE(myList.size() == static_cast<size_t>(n));
+        }
+        WHEN("reversing the list"){
+            myList.reverse();
+            int i = n-1;
+            for(DListIterator it = myList.begin(); it != myList.end(); ++it){
+                REQUIRE((*it).i == i--);
+            }
+            REQUIRE(myList.back().i == 0);
+        }
+    }
+}
+
+// Allocates and frees from its destructor, which runs at thread exit after
+//   the thread's slab cache is gone if it was constructed before that cache.
+struct LateSlabUser{
+    SlabPool* pool = nullptr;
+    static bool distinct;
+
+    ~LateSlabUser(){
+        if(pool == nullptr){
+            return;
+        }
+        const int n = 400;   // Two batches together fill more than two slabs
+        void* objects[n];
+        set<void*> seen;
+        for(int i = 0; i < n; ++i){
+            objects[i] = pool->allocate();
+            seen.insert(objects[i]);
+        }
+        void* batch[n];
+        pool->allocate_n(batch, n);
+        for(int i = 0; i < n; ++i){
+            seen.insert(batch[i]);
+        }
+        distinct = seen.size() == static_cast<size_t>(2 * n);
+        for(int i = 0; i < n; ++i){
+            SlabPool::free(objects[i]);
+            SlabPool::free(batch[i]);
+        }
+    }
+};
+bool LateSlabUser::distinct = false;
+
+TEST_CASE("18-slab-pool", "[18]"){
+    SlabPool& pool = SlabPool::for_size(24);
+    REQUIRE(pool.object_size() == 32);
+    REQUIRE(&SlabPool::for_size(32) == &pool);
+    REQUIRE_THROWS(SlabPool::for_size(SlabPool::max_object_size + 1));
+
+    GIVEN("Enough objects to fill several slabs"){
+        const int n = 10000;
+        void** objects = new void*[n];
+        set<void*> distinct;
+        for(int i = 0; i < n; ++i){
+            objects[i] = pool.allocate();
+            distinct.insert(objects[i]);
+            UNSCOPED_INFO("objects should be 16 byte aligned");
+            REQUIRE(reinterpret_cast<std::uintptr_t>(objects[i]) % 16 == 0);
+            std::memset(objects[i], 0xAB, pool.object_size());
+        }
+        UNSCOPED_INFO("every object should be distinct");
+        REQUIRE(distinct.size() == static_cast<size_t>(n));
+        REQUIRE(pool.slab_count() >= n * 32 / SlabPool::slab_size);
+
+        WHEN("every object is freed"){
+            for(int i = 0; i < n; ++i){
+                SlabPool::free(objects[i]);
+            }
+            pool.flush_thread_cache();
+            THEN("empty slabs are given back, keeping one spare"){
+                REQUIRE(pool.slab_count() <= 1);
+            }
+        }
+        delete [] objects;
+    }
+
+    GIVEN("Several threads allocating and freeing"){
+        std::thread workers[4];
+        bool ok[4] = {true, true, true, true};
+        for(int t = 0; t < 4; ++t){
+            workers[t] = std::thread([&, t]{
+                int* held[500];
+                for(int round = 0; round < 20; ++round){
+                    for(int i = 0; i < 500; ++i){
+                        held[i] = static_cast<int*>(pool.allocate());
+                        *held[i] = t * 1000 + i;
+                    }
+                    for(int i = 0; i < 500; ++i){
+                        if(*held[i] != t * 1000 + i) ok[t] = false;
+                        SlabPool::free(held[i]);
+                    }
+                }
+            });
+        }
+        for(int t = 0; t < 4; ++t){
+            workers[t].join();
+            REQUIRE(ok[t]);
+        }
+        pool.flush_thread_cache();
+        UNSCOPED_INFO("exiting threads should have flushed their caches");
+        REQUIRE(pool.slab_count() <= 1);
+    }
+
+    GIVEN("A thread_local destructor that runs after the thread's cache is destroyed"){
+        SlabPool& late_pool = SlabPool::for_size(200);
+        std::thread worker([&]{
+            static thread_local LateSlabUser user;
+            user.pool = &late_pool;
+            SlabPool::free(late_pool.allocate());
+        });
+        worker.join();
+        THEN("it gets distinct objects and its frees reach the slabs"){
+            REQUIRE(LateSlabUser::distinct);
+            REQUIRE(late_pool.slab_count() <= 1);
+        }
+    }
+}
+
+TEST_CASE("19-arena-list", "[19]"){
+    GIVEN("Lists whose links come from an arena"){
+        auto link_counter = n_allocated_links;
+        LinkArena arena;
+        int n = 10000;
+        LinkedList* myList = new LinkedList(arena);
+        for(int i = 0; i < n; ++i){
+            myList->push_back(Thing(i));
+        }
+        myList->push_front(Thing(-1));
+        myList->pop_back();
+        UNSCOPED_INFO("arena links should not go through Link::operator new");
+        REQUIRE(n_allocated_links == link_counter);
+        REQUIRE(myList->size() == static_cast<size_t>(n));
+        REQUIRE(myList->at(n/2).i == n/2 - 1);
+
+        LinkedList* myCopy = myList->copy();
+        REQUIRE(n_allocated_links == link_counter);
+        REQUIRE(myCopy->back().i == n-2);
+
+        WHEN("the lists are destroyed and the arena reset"){
+            size_t blocks = arena.block_count();
+            REQUIRE(blocks > 1);
+            delete myList;
+            delete myCopy;
+            arena.reset();
+            THEN("only one block is kept for reuse"){
+                REQUIRE(arena.block_count() == 1);
+                LinkedList reused(arena);
+                reused.push_back(Thing(7));
+                REQUIRE(reused.front().i == 7);
+                REQUIRE(arena.block_count() == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("20-unrolled-list", "[20]"){
+    REQUIRE(sizeof(UnrolledNode) <= 128);
+    REQUIRE(alignof(UnrolledNode) == 64);
+
+    GIVEN("An unrolled list checked against a deque"){
+        UnrolledList myList;
+        deque<int> expected;
+        int n = 1000;
+        for(int i = 0; i < n; ++i){
+            myList.push_back(Thing(i));
+            expected.push_back(i);
+        }
+        UNSCOPED_INFO("push_back should fill nodes completely");
+        REQUIRE(myList.node_count() == (n + UnrolledNode::capacity - 1) / UnrolledNode::capacity);
+
+        for(int i = 0; i < 200; ++i){
+            size_t pos = (i * 37) % (expected.size() + 1);
+            myList.insert(pos, Thing(-i));
+            expected.insert(expected.begin() + pos, -i);
+        }
+        for(int i = 0; i < 600; ++i){
+            size_t pos = (i * 53) % expected.size();
+            myList.erase(pos);
+            expected.erase(expected.begin() + pos);
+        }
+        myList.push_front(Thing(7));   expected.push_front(7);
+        myList.pop_back();             expected.pop_back();
+        myList.pop_front();            expected.pop_front();
+
+        THEN("indexing and iteration agree with the deque"){
+            REQUIRE(myList.size() == expected.size());
+            for(size_t i = 0; i < expected.size(); ++i){
+                REQUIRE(myList.at(i).i == expected[i]);
+            }
+            size_t i = 0;
+            for(UnrolledListIterator it = myList.begin(); it != myList.end(); ++it){
+                REQUIRE((*it).i == expected[i++]);
+            }
+            REQUIRE(i == expected.size());
+            REQUIRE(myList.front().i == expected.front());
+            REQUIRE(myList.back().i == expected.back());
+            REQUIRE_THROWS(myList.at(expected.size()));
+        }
+        THEN("erasing merges nodes that become sparse"){
+            REQUIRE(myList.node_count() <= 2 * expected.size() / UnrolledNode::capacity + 2);
+        }
+        THEN("every node sits on cache line boundaries"){
+            for(UnrolledNode* node = myList.begin().node; node != nullptr; node = node->next){
+                REQUIRE(reinterpret_cast<std::uintptr_t>(node) % 64 == 0);
+            }
+        }
+        WHEN("splicing another list onto the end"){
+            UnrolledList other;
+            other.push_back(Thing(12345));
+            myList.splice_back(other);
+            REQUIRE(other.size() == 0);
+            REQUIRE(myList.back().i == 12345);
+            REQUIRE(myList.size() == expected.size() + 1);
+        }
+    }
+}
+
+// Sits on a run queue through its base hook and on a per-owner list
+//   through a member hook at the same time.
+class Job : public IntrusiveBaseHook<>{
+public:
+    Thing value;
+    IntrusiveHook by_owner;
+    Job(int i = 0) : value(i){}
+};
+
+TEST_CASE("21-intrusive-list", "[21]"){
+    GIVEN("Objects on two lists at once"){
+        auto link_counter = n_allocated_links;
+        Job jobs[10];
+        for(int i = 0; i < 10; ++i) jobs[i].value = Thing(i);
+
+        IntrusiveList<Job> run_queue;
+        IntrusiveList<Job, MemberHook<Job, &Job::by_owner>> owned;
+        for(int i = 0; i < 10; ++i){
+            run_queue.push_back(jobs[i]);
+            if(i % 2 == 0) owned.push_front(jobs[i]);
+        }
+        UNSCOPED_INFO("inserting should not allocate links");
+        REQUIRE(n_allocated_links == link_counter);
+        REQUIRE(run_queue.size() == 10);
+        REQUIRE(owned.size() == 5);
+        REQUIRE(&owned.front() == &jobs[8]);
+        REQUIRE(&owned.back() == &jobs[0]);
+
+        THEN("each list iterates over the objects themselves"){
+            int i = 0;
+            for(auto it = run_queue.begin(); it != run_queue.end(); ++it){
+                REQUIRE(&*it == &jobs[i++]);
+            }
+            auto it = owned.end();
+            --it;
+            REQUIRE(it->value.i == 0);
+        }
+        WHEN("an object is removed from one list"){
+            run_queue.remove(jobs[4]);
+            THEN("it stays on the other"){
+                REQUIRE_FALSE(jobs[4].is_linked());
+                REQUIRE(jobs[4].by_owner.is_linked());
+                REQUIRE(run_queue.size() == 9);
+                owned.remove(jobs[4]);
+                REQUIRE(owned.size() == 4);
+            }
+        }
+        WHEN("popping and reversing"){
+            run_queue.pop_front();
+            run_queue.pop_back();
+            run_queue.reverse();
+            REQUIRE(&run_queue.front() == &jobs[8]);
+            REQUIRE(&run_queue.back() == &jobs[1]);
+            REQUIRE_FALSE(jobs[0].is_linked());
+        }
+        run_queue.clear();
+        owned.clear();
+    }
+}
+
+TEST_CASE("22-compact-list", "[22]"){
+    GIVEN("A compact list filled from both ends"){
+        auto link_counter = n_allocated_links;
+        CompactList list;
+        for(int i = 0; i < 100; ++i){
+            list.push_back(Thing(i));
+            list.push_front(Thing(-i - 1));
+        }
+        UNSCOPED_INFO("nodes live in the list's own array, not in Links");
+        REQUIRE(n_allocated_links == link_counter);
+        REQUIRE(sizeof(CompactNode) == 8);
+        REQUIRE(list.size() == 200);
+        REQUIRE(list.used() == 200);
+        REQUIRE(list.capacity() >= list.used());
+        REQUIRE(list.front().i == -100);
+        REQUIRE(list.back().i == 99);
+        REQUIRE(list.at(100).i == 0);
+        REQUIRE_THROWS_AS(list.at(200), std::out_of_range);
+
+        THEN("iteration visits the items in order"){
+            int expected = -100;
+            for(auto it = list.begin(); it != list.end(); ++it){
+                REQUIRE((*it).i == expected++);
+            }
+            REQUIRE(expected == 100);
+        }
+        WHEN("items are removed and added again"){
+            size_t capacity = list.capacity();
+            for(int i = 0; i < 50; ++i){
+                list.pop_front();
+                list.pop_back();
+            }
+            for(int i = 0; i < 100; ++i){
+                list.push_back(Thing(1000 + i));
+            }
+            THEN("freed slots are reused before the array grows"){
+                REQUIRE(list.capacity() == capacity);
+                REQUIRE(list.used() == 200);
+                REQUIRE(list.size() == 200);
+                REQUIRE(list.front().i == -50);
+                REQUIRE(list.back().i == 1099);
+            }
+        }
+        WHEN("the list is reversed and compacted"){
+            for(int i = 0; i < 20; ++i) list.pop_front();
+            list.reverse();
+            list.compact();
+            THEN("node i holds item i and the array has no spare slots"){
+                REQUIRE(list.capacity() == 180);
+                REQUIRE(list.used() == 180);
+                REQUIRE(list.head_index() == 0);
+                const CompactNode *nodes = list.data();
+                for(uint32_t i = 0; i < 180; ++i){
+                    REQUIRE(nodes[i].value.i == 99 - int(i));
+                    REQUIRE(nodes[i].next == (i + 1 < 180 ? i + 1 : CompactNode::none));
+                }
+                list.push_back(Thing(7));
+                REQUIRE(list.back().i == 7);
+                REQUIRE(list.at(180).i == 7);
+            }
+        }
+        WHEN("the list is emptied and compacted"){
+            while(list.size() > 0) list.pop_back();
+            list.compact();
+            REQUIRE(list.capacity() == 0);
+            REQUIRE_FALSE(list.begin() != list.end());
+            list.push_front(Thing(3));
+            REQUIRE(list.front().i == 3);
+            REQUIRE(list.back().i == 3);
+        }
+    }
+}
+
+TEST_CASE("23-skip-list", "[23]"){
+    GIVEN("A skip list filled in shuffled order"){
+        SkipList list;
+        for(int i = 0; i < 1000; ++i){
+            list.insert(Thing((i * 7919) % 1000));
+        }
+        REQUIRE(list.size() == 1000);
+        REQUIRE(list.levels() > 1);
+
+        THEN("items come out sorted, by iteration and by index"){
+            int expected = 0;
+            for(auto it = list.begin(); it != list.end(); ++it){
+                REQUIRE((*it).i == expected++);
+            }
+            for(size_t i = 0; i < 1000; ++i){
+                REQUIRE(list.at(i).i == int(i));
+            }
+            REQUIRE_THROWS_AS(list.at(1000), std::out_of_range);
+        }
+        THEN("find locates present keys only"){
+            REQUIRE(list.find(Thing(500))->i == 500);
+            REQUIRE(list.find(Thing(1000)) == nullptr);
+            REQUIRE_FALSE(list.contains(Thing(-1)));
+        }
+        WHEN("every even key is erased and duplicates are added"){
+            for(int i = 0; i < 1000; i += 2){
+                REQUIRE(list.erase(Thing(i)));
+            }
+            REQUIRE_FALSE(list.erase(Thing(0)));
+            list.insert(Thing(1));
+            list.insert(Thing(999));
+            THEN("positions still match the remaining items"){
+                REQUIRE(list.size() == 502);
+                REQUIRE(list.at(0).i == 1);
+                REQUIRE(list.at(1).i == 1);
+                REQUIRE(list.at(2).i == 3);
+                REQUIRE(list.at(250).i == 499);
+                REQUIRE(list.at(501).i == 999);
+                REQUIRE(list.at(500).i == 999);
+            }
+        }
+        WHEN("the list is cleared"){
+            list.clear();
+            REQUIRE(list.empty());
+            REQUIRE(list.levels() == 1);
+            REQUIRE_FALSE(list.begin() != list.end());
+            list.insert(Thing(4));
+            REQUIRE(list.at(0).i == 4);
+        }
+    }
+}
+
+TEST_CASE("24-lock-free-stack", "[24]"){
+    GIVEN("An empty lock-free stack"){
+        LockFreeStack stack;
+        Thing out;
+        REQUIRE_FALSE(stack.try_pop(out));
+
+        THEN("it is last in, first out and reuses its nodes"){
+            for(int i = 0; i < 10; ++i) stack.push(Thing(i));
+            for(int i = 9; i >= 0; --i){
+                REQUIRE(stack.try_pop(out));
+                REQUIRE(out.i == i);
+            }
+            REQUIRE(stack.empty_approx());
+            for(int i = 0; i < 10; ++i) stack.push(Thing(i));
+            REQUIRE(stack.allocated_nodes() == 10);
+        }
+        WHEN("several threads push and pop at once"){
+            const int n_threads = 4, per_thread = 20000;
+            std::atomic<long long> popped_sum(0);
+            std::atomic<int> popped(0);
+            std::thread threads[n_threads];
+            for(int t = 0; t < n_threads; ++t){
+                threads[t] = std::thread([&, t]{
+                    Thing item;
+                    for(int i = 0; i < per_thread; ++i){
+                        stack.push(Thing(t * per_thread + i));
+                        if(i % 2 == 1){
+                            while(!stack.try_pop(item)){}
+                            popped_sum += item.i;
+                            ++popped;
+                        }
+                    }
+                });
+            }
+            for(auto& thread : threads) thread.join();
+            THEN("every item comes out exactly once"){
+                long long sum = popped_sum;
+                int count = popped;
+                while(stack.try_pop(out)){
+                    sum += out.i;
+                    ++count;
+                }
+                long long n = n_threads * per_thread;
+                REQUIRE(count == n);
+                REQUIRE(sum == n * (n - 1) / 2);
+            }
+        }
+    }
+}
+
+TEST_CASE("25-lock-free-queue", "[25]"){
+    GIVEN("An empty lock-free queue"){
+        LockFreeQueue queue;
+        Thing out;
+        REQUIRE_FALSE(queue.try_pop(out));
+        REQUIRE(queue.empty_approx());
+
+        THEN("it is first in, first out and reuses its nodes"){
+            for(int round = 0; round < 3; ++round){
+                for(int i = 0; i < 10; ++i) queue.push(Thing(i));
+                for(int i = 0; i < 10; ++i){
+                    REQUIRE(queue.try_pop(out));
+                    REQUIRE(out.i == i);
+                }
+                REQUIRE_FALSE(queue.try_pop(out));
+            }
+            REQUIRE(queue.allocated_nodes() == 11);
+        }
+        WHEN("several producers feed several consumers"){
+            const int n_producers = 3, n_consumers = 3, per_producer = 20000;
+            const int total = n_producers * per_producer;
+            std::atomic<int> consumed(0);
+            std::atomic<bool> in_order(true);
+            std::atomic<long long> sum(0);
+            std::thread threads[n_producers + n_consumers];
+            for(int t = 0; t < n_producers; ++t){
+                threads[t] = std::thread([&, t]{
+                    for(int i = 0; i < per_producer; ++i){
+                        queue.push(Thing(t * per_producer + i));
+                    }
+                });
+            }
+            for(int t = 0; t < n_consumers; ++t){
+                threads[n_producers + t] = std::thread([&]{
+                    int last_seen[n_producers] = {-1, -1, -1};
+                    Thing item;
+                    while(consumed.load() < total){
+                        if(!queue.try_pop(item)){
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        int producer = item.i / per_producer;
+                        if(item.i <= last_seen[producer]) in_order = false;
+                        last_seen[producer] = item.i;
+                        sum += item.i;
+                        ++consumed;
+                    }
+                });
+            }
+            for(auto& thread : threads) thread.join();
+            THEN("every item comes out once, in the order its producer pushed it"){
+                REQUIRE(consumed.load() == total);
+                REQUIRE(sum.load() == (long long)total * (total - 1) / 2);
+                REQUIRE(in_order.load());
+                REQUIRE_FALSE(queue.try_pop(out));
+            }
+        }
+    }
+}
+
+int n_reclaimed = 0;
+void count_reclaimed(void* ptr){
+    ++n_reclaimed;
+    delete static_cast<Thing*>(ptr);
+}
+
+TEST_CASE("26-reclamation", "[26]"){
+    GIVEN("An epoch domain and a reader inside a guard"){
+        EpochDomain domain;
+        n_reclaimed = 0;
+        std::atomic<int> stage(0);
+        std::thread reader([&]{
+            EpochDomain::Guard guard(domain);
+            stage = 1;
+            while(stage != 2) std::this_thread::yield();
+        });
+        while(stage != 1) std::this_thread::yield();
+        for(int i = 0; i < 10; ++i) domain.retire(new Thing(i), &count_reclaimed);
+        domain.collect();
+        domain.collect();
+        UNSCOPED_INFO("nothing is freed while the reader may still see it");
+        REQUIRE(n_reclaimed == 0);
+        REQUIRE(domain.pending() == 10);
+
+        stage = 2;
+        reader.join();
+        domain.collect();
+        domain.collect();
+        REQUIRE(n_reclaimed == 10);
+        REQUIRE(domain.pending() == 0);
+
+        THEN("a retired Link goes back through Link::operator delete"){
+            auto link_counter = n_allocated_links;
+            Link* link = new Link(Thing(1));
+            domain.retire(link);
+            REQUIRE(n_allocated_links == link_counter + 1);
+            domain.collect();
+            domain.collect();
+            REQUIRE(n_allocated_links == link_counter);
+            REQUIRE_FALSE(still_allocated[link]);
+        }
+    }
+    GIVEN("A hazard domain and a protected pointer"){
+        HazardDomain domain;
+        n_reclaimed = 0;
+        std::atomic<Thing*> shared(new Thing(5));
+        Thing* seen = domain.protect(0, shared);
+        REQUIRE(seen->i == 5);
+        shared.store(nullptr);
+        domain.retire(seen, &count_reclaimed);
+        REQUIRE(domain.collect() == 0);
+        REQUIRE(seen->i == 5);
+        domain.clear(0);
+        REQUIRE(domain.collect() == 1);
+        REQUIRE(n_reclaimed == 1);
+    }
+    GIVEN("More threads over time than a domain has records"){
+        EpochDomain domain;
+        n_reclaimed = 0;
+        int n_threads = int(ReclaimDomain::max_threads) + 72;
+        for(int t = 0; t < n_threads; ++t){
+            std::thread worker([&]{
+                domain.retire(new Thing(t), &count_reclaimed);
+            });
+            worker.join();
+        }
+        THEN("exited threads give their records back and their garbage is adopted"){
+            REQUIRE(n_reclaimed == 0);
+            domain.collect();
+            domain.collect();
+            REQUIRE(n_reclaimed == n_threads);
+            REQUIRE(domain.pending() == 0);
+        }
+    }
+    GIVEN("A thread that retires into a hazard domain and exits"){
+        HazardDomain domain;
+        n_reclaimed = 0;
+        std::thread worker([&]{
+            for(int i = 0; i < 5; ++i) domain.retire(new Thing(i), &count_reclaimed);
+            HazardDomain own;
+            own.retire(new Thing(-1), &count_reclaimed);
+        });
+        worker.join();
+        UNSCOPED_INFO("the worker's own domain was destroyed before it exited");
+        REQUIRE(n_reclaimed == 1);
+        REQUIRE(domain.collect() == 5);
+        REQUIRE(n_reclaimed == 6);
+    }
+    GIVEN("Readers walking a chain while a writer replaces its nodes"){
+        EpochDomain domain;
+        std::atomic<StackNode*> head(nullptr);
+        for(int i = 0; i < 100; ++i){
+            StackNode* node = new StackNode;
+            node->value = Thing(i);
+            node->next.store(head.load());
+            head.store(node);
+        }
+        std::atomic<bool> done(false);
+        std::atomic<bool> intact(true);
+        std::thread readers[2];
+        for(auto& reader : readers){
+            reader = std::thread([&]{
+                while(!done){
+                    EpochDomain::Guard guard(domain);
+                    for(StackNode* curr = head.load(std::memory_order_acquire); curr != nullptr;
+                        curr = curr->next.load(std::memory_order_acquire)){
+                        if(curr->value.i < 0) intact = false;
+                    }
+                }
+            });
+        }
+        for(int i = 100; i < 20000; ++i){
+            StackNode* old = head.load();
+            StackNode* node = new StackNode;
+            node->value = Thing(i);
+            node->next.store(old->next.load());
+            head.store(node, std::memory_order_release);
+            domain.retire(old);
+        }
+        done = true;
+        for(auto& reader : readers) reader.join();
+        REQUIRE(intact);
+        StackNode* curr = head.load();
+        while(curr != nullptr){
+            StackNode* next = curr->next.load();
+            delete curr;
+            curr = next;
+        }
+    }
+    GIVEN("A tree whose removed nodes are retired"){
+        EpochDomain domain;
+        Tree tree;
+        tree.set_retire_hook([](TreeNode* node, void* context){
+            static_cast<EpochDomain*>(context)->retire(node);
+        }, &domain);
+        int values[] = {5, 3, 8, 1, 4};
+        for(int v : values) tree.insert(v);
+
+        tree.remove(3);
+        tree.remove(5);
+        tree.remove(8);
+        REQUIRE(domain.pending() == 3);
+        REQUIRE(tree.min() == 1);
+        REQUIRE(tree.max() == 4);
+        REQUIRE_FALSE(tree.contains(5));
+        REQUIRE_FALSE(tree.contains(8));
+        UNSCOPED_INFO("retired nodes no longer own their children");
+        domain.collect();
+        domain.collect();
+        REQUIRE(domain.pending() == 0);
+        REQUIRE(tree.contains(1));
+        REQUIRE(tree.contains(4));
+    }
+}
+
+TEST_CASE("27-lazy-list", "[27]"){
+    GIVEN("An empty lazy list"){
+        LazyList set;
+        REQUIRE_FALSE(set.contains(Thing(1)));
+
+        THEN("it behaves as a sorted set"){
+            REQUIRE(set.insert(Thing(5)));
+            REQUIRE(set.insert(Thing(1)));
+            REQUIRE(set.insert(Thing(3)));
+            REQUIRE_FALSE(set.insert(Thing(3)));
+            REQUIRE(set.size_approx() == 3);
+            REQUIRE(set.contains(Thing(3)));
+            REQUIRE(set.erase(Thing(3)));
+            REQUIRE_FALSE(set.erase(Thing(3)));
+            REQUIRE_FALSE(set.contains(Thing(3)));
+            REQUIRE(set.contains(Thing(5)));
+            REQUIRE(set.size_approx() == 2);
+        }
+        THEN("the sentinels' keys are rejected"){
+            REQUIRE_THROWS_AS(set.insert(Thing(INT_MIN)), std::invalid_argument);
+            REQUIRE_THROWS_AS(set.insert(Thing(INT_MAX)), std::invalid_argument);
+            REQUIRE_THROWS_AS(set.erase(Thing(INT_MAX)), std::invalid_argument);
+            REQUIRE_THROWS_AS(set.erase(Thing(INT_MIN)), std::invalid_argument);
+            REQUIRE_FALSE(set.contains(Thing(INT_MAX)));
+            REQUIRE_FALSE(set.contains(Thing(INT_MIN)));
+            REQUIRE(set.insert(Thing(INT_MAX - 1)));
+            REQUIRE(set.insert(Thing(INT_MIN + 1)));
+            REQUIRE(set.contains(Thing(INT_MAX - 1)));
+            REQUIRE(set.size_approx() == 2);
+        }
+        WHEN("threads update neighbouring keys while another thread reads"){
+            const int n_writers = 4, key_range = 200, never_erased = 1000;
+            set.insert(Thing(never_erased));
+            std::atomic<bool> done(false);
+            std::atomic<bool> consistent(true);
+            std::thread reader([&]{
+                while(!done){
+                    if(set.contains(Thing(-5))) consistent = false;
+                    if(!set.contains(Thing(never_erased))) consistent = false;
+                }
+            });
+            std::thread writers[n_writers];
+            for(int t = 0; t < n_writers; ++t){
+                writers[t] = std::thread([&, t]{
+                    // Writer t owns the keys k with k % n_writers == t.
+                    for(int round = 0; round < 20; ++round){
+                        for(int k = t; k < key_range; k += n_writers) set.insert(Thing(k));
+                        for(int k = t; k < key_range; k += 2 * n_writers) set.erase(Thing(k));
+                    }
+                });
+            }
+            for(auto& writer : writers) writer.join();
+            done = true;
+            reader.join();
+            THEN("readers never saw a missing or phantom key and every writer's last round stuck"){
+                REQUIRE(consistent);
+                for(int k = 0; k < key_range; ++k){
+                    REQUIRE(set.contains(Thing(k)) == ((k / n_writers) % 2 == 1));
+                }
+                REQUIRE(set.size_approx() == key_range / 2 + 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("28-copy-on-write", "[28]"){
+    GIVEN("A list with a random number of items in it and a shared copy"){
+        auto link_counter = n_allocated_links;
+        unsigned int n = rand() % 100 + 50;
+        LinkedList* myList;
+        deque<Link*> links;
+        tie(myList, links) = get_list(n);
+
+        LinkedList* shared = myList->share();
+        UNSCOPED_INFO("sharing should not allocate any links");
+        REQUIRE(n_allocated_links - link_counter == int(n));
+        REQUIRE(shared->head == myList->head);
+        REQUIRE(shared->size() == n);
+        REQUIRE(myList->is_shared());
+        REQUIRE(shared->is_shared());
+
+        WHEN("the copy is modified"){
+            shared->push_back(Thing(-1));
+            THEN("it gets its own links and the original is untouched"){
+                REQUIRE(n_allocated_links - link_counter == int(2 * n + 1));
+                REQUIRE(shared->head != myList->head);
+                REQUIRE_FALSE(shared->is_shared());
+                REQUIRE_FALSE(myList->is_shared());
+                REQUIRE(myList->size() == n);
+                REQUIRE(myList->back() == links.back()->value);
+                REQUIRE(shared->back().i == -1);
+                for(unsigned int i = 0; i < n; ++i){
+                    REQUIRE(shared->at(i) == myList->at(i));
+                }
+                UNSCOPED_INFO("the original still owns its links and modifies them in place");
+                myList->front() = Thing(7);
+                REQUIRE(myList->head == links.front());
+                REQUIRE(links.front()->value.i == 7);
+            }
+        }
+        WHEN("the copy is only read through a const reference"){
+            const LinkedList& view = *shared;
+            long sum = 0;
+            for(const Thing& t : view){
+                sum += t.i;
+            }
+            long expected = 0;
+            for(Link* link : links){
+                expected += link->value.i;
+            }
+            THEN("it still shares the original's links"){
+                REQUIRE(sum == expected);
+                REQUIRE(view.front() == links.front()->value);
+                REQUIRE(view.back() == links.back()->value);
+                for(unsigned int i = 0; i < n; ++i){
+                    REQUIRE(view.at(i) == links[i]->value);
+                }
+                REQUIRE_THROWS_AS(view.at(n), std::out_of_range);
+                REQUIRE(view.size() == n);
+                REQUIRE(shared->is_shared());
+                REQUIRE(shared->head == myList->head);
+                REQUIRE(n_allocated_links - link_counter == int(n));
+            }
+        }
+        WHEN("copying the links fails partway"){
+            fail_link_alloc_in = int(n) - 10;
+            REQUIRE_THROWS_AS(shared->push_back(Thing(-1)), std::bad_alloc);
+            THEN("the list still shares the old links and nothing leaks"){
+                REQUIRE(fail_link_alloc_in == 0);
+                REQUIRE(n_allocated_links - link_counter == int(n));
+                REQUIRE(shared->head == myList->head);
+                REQUIRE(shared->is_shared());
+                REQUIRE(shared->size() == n);
+                fail_link_alloc_in = 70;
+                REQUIRE_THROWS_AS(shared->copy(), std::bad_alloc);
+                REQUIRE(n_allocated_links - link_counter == int(n));
+                delete myList;
+                delete shared;
+                REQUIRE(n_allocated_links == link_counter);
+            }
+        }
+        WHEN("the original is deleted first"){
+            delete myList;
+            THEN("the copy keeps the links alive"){
+                REQUIRE(still_allocated[links.front()]);
+                REQUIRE_FALSE(shared->is_shared());
+                REQUIRE(shared->size() == n);
+                shared->pop_front();
+                UNSCOPED_INFO("the last user of the links modifies them without copying");
+                REQUIRE_FALSE(still_allocated[links.front()]);
+                REQUIRE(n_allocated_links - link_counter == int(n - 1));
+            }
+            delete shared;
+            REQUIRE(n_allocated_links == link_counter);
+        }
+    }
+}
+
+TEST_CASE("29-cons-list", "[29]"){
+    GIVEN("Versions of a persistent list built from a common base"){
+        ConsList empty;
+        ConsList base = empty.push_front(Thing(2)).push_front(Thing(1));
+        ConsList left = base.push_front(Thing(10));
+        ConsList right = base.push_front(Thing(20));
+        ConsList snapshot = left;
+
+        THEN("each version sees its own items and shares the tail"){
+            REQUIRE(empty.empty());
+            REQUIRE(base.size() == 2);
+            REQUIRE(left.size() == 3);
+            REQUIRE(left.front().i == 10);
+            REQUIRE(right.front().i == 20);
+            REQUIRE(left.pop_front().front().i == 1);
+            REQUIRE(left.shares_nodes_with(right));
+            REQUIRE(snapshot.shares_nodes_with(left));
+            REQUIRE_FALSE(left.shares_nodes_with(empty.push_front(Thing(2))));
+            REQUIRE(left.shares_nodes_with(right.pop_front().pop_front()));
+            REQUIRE_FALSE(left.pop_front().pop_front().pop_front().shares_nodes_with(right));
+            REQUIRE_FALSE(base.shares_nodes_with(empty.push_front(Thing(2)).push_front(Thing(1))));
+            int expected[] = {20, 1, 2};
+            int i = 0;
+            for(auto it = right.begin(); it != right.end(); ++it){
+                REQUIRE((*it).i == expected[i++]);
+            }
+        }
+        WHEN("a version is replaced"){
+            left = left.pop_front().pop_front();
+            THEN("snapshots of it are unaffected"){
+                REQUIRE(left.size() == 1);
+                REQUIRE(left.front().i == 2);
+                REQUIRE(snapshot.size() == 3);
+                REQUIRE(snapshot.front().i == 10);
+            }
+        }
+    }
+    GIVEN("A very long list"){
+        ConsList list;
+        for(int i = 0; i < 1000000; ++i){
+            list = list.push_front(Thing(i));
+        }
+        REQUIRE(list.size() == 1000000);
+        THEN("dropping it does not recurse"){
+            list = ConsList();
+            REQUIRE(list.empty());
+        }
+    }
+    GIVEN("Readers holding snapshots while a writer keeps pushing"){
+        ConsList list;
+        for(int i = 0; i < 100; ++i) list = list.push_front(Thing(i));
+        std::atomic<bool> consistent(true);
+        std::thread readers[2];
+        ConsList start[2] = {list, list.pop_front()};
+        for(int t = 0; t < 2; ++t){
+            readers[t] = std::thread([&, t]{
+                ConsList mine = start[t];
+                size_t n = 0;
+                for(auto it = mine.begin(); it != mine.end(); ++it) ++n;
+                if(n != mine.size()) consistent = false;
+            });
+        }
+        for(int i = 0; i < 10000; ++i){
+            list = list.push_front(Thing(i));
+            if(i % 2) list = list.pop_front();
+        }
+        for(auto& reader : readers) reader.join();
+        REQUIRE(consistent);
+        REQUIRE(list.size() == 5100);
+    }
+}
+
+TEST_CASE("30-sort", "[30]"){
+    GIVEN("A list with a random number of items in reverse order"){
+        auto link_counter = n_allocated_links;
+        unsigned int n = rand() % 100 + 50;
+        LinkedList* myList;
+        deque<Link*> links;
+        tie(myList, links) = get_list(n);
+
+        WHEN("the list is sorted"){
+            myList->sort();
+            THEN("it is reversed by relinking the same links"){
+                REQUIRE(n_allocated_links - link_counter == int(n));
+                for(unsigned int i = 0; i < n; ++i){
+                    REQUIRE(myList->get_link(i) == links[n - 1 - i]);
+                }
+                myList->push_back(Thing(100000));
+                REQUIRE(links.front()->next->value.i == 100000);
+            }
+        }
+        WHEN("the items are shuffled with repeated keys"){
+            // Key in the thousands, original position below.
+            for(unsigned int i = 0; i < n; ++i){
+                links[i]->value = Thing(int(rand() % 10) * 1000 + int(i));
+            }
+            myList->sort([](const Thing& a, const Thing& b){ return a.i / 1000 < b.i / 1000; });
+            THEN("keys are in order and equal keys keep their order"){
+                REQUIRE(n_allocated_links - link_counter == int(n));
+                REQUIRE(myList->size() == n);
+                Link* prev = nullptr;
+                for(Link* curr = myList->head; curr != nullptr; curr = curr->next){
+                    if(prev != nullptr){
+                        REQUIRE(prev->value.i / 1000 <= curr->value.i / 1000);
+                        if(prev->value.i / 1000 == curr->value.i / 1000){
+                            REQUIRE(prev->value.i < curr->value.i);
+                        }
+                    }
+                    prev = curr;
+                }
+                UNSCOPED_INFO("the tail should be the last link after sorting");
+                REQUIRE(&myList->back() == &prev->value);
+                myList->push_back(Thing(-1));
+                REQUIRE(prev->next->value.i == -1);
+            }
+        }
+        WHEN("a sorted list is sorted again"){
+            myList->sort();
+            Link* first = myList->head;
+            myList->sort();
+            REQUIRE(myList->head == first);
+            REQUIRE(myList->front().i == 0);
+        }
+    }
+}
+
+// Values of a list from front to back.
+deque<int> values_of(LinkedList& list){
+    deque<int> values;
+    for(auto it = list.begin(); it != list.end(); ++it) values.push_back((*it).i);
+    return values;
+}
+
+TEST_CASE("31-splice-split-merge", "[31]"){
+    GIVEN("Two lists"){
+        auto link_counter = n_allocated_links;
+        LinkedList a, b;
+        for(int i = 0; i < 5; ++i) a.push_back(Thing(i));
+        for(int i = 10; i < 13; ++i) b.push_back(Thing(i));
+        Link* first_of_b = b.head;
+
+        WHEN("b is concatenated to a"){
+            a.concat(b);
+            THEN("the links move without allocating"){
+                REQUIRE(n_allocated_links - link_counter == 8);
+                REQUIRE(values_of(a) == deque<int>({0, 1, 2, 3, 4, 10, 11, 12}));
+                REQUIRE(a.get_link(5) == first_of_b);
+                REQUIRE(a.size() == 8);
+                REQUIRE(a.back().i == 12);
+                REQUIRE(b.size() == 0);
+                REQUIRE(b.head == nullptr);
+                b.push_back(Thing(1));
+                REQUIRE(b.size() == 1);
+            }
+        }
+        WHEN("part of b is spliced into the middle of a"){
+            LinkedListIterator pos = a.begin();
+            ++pos;
+            LinkedListIterator before_first = b.begin();
+            LinkedListIterator last = before_first;
+            ++last;
+            ++last;
+            a.splice_after(pos, b, before_first, last);
+            THEN("both lists are relinked and recounted"){
+                REQUIRE(values_of(a) == deque<int>({0, 1, 11, 12, 2, 3, 4}));
+                REQUIRE(values_of(b) == deque<int>({10}));
+                REQUIRE(a.size() == 7);
+                REQUIRE(b.size() == 1);
+                REQUIRE(b.back().i == 10);
+                b.push_back(Thing(13));
+                REQUIRE(values_of(b) == deque<int>({10, 13}));
+                a.push_back(Thing(5));
+                REQUIRE(a.size() == 8);
+            }
+        }
+        WHEN("the front of b is spliced to the front of a"){
+            LinkedListIterator last = b.begin();
+            a.splice_after(a.end(), b, b.end(), last);
+            REQUIRE(values_of(a) == deque<int>({10, 0, 1, 2, 3, 4}));
+            REQUIRE(b.front().i == 11);
+            REQUIRE(b.size() == 2);
+        }
+        WHEN("all of b is spliced after a's last link"){
+            LinkedListIterator pos = a.begin();
+            for(int i = 0; i < 4; ++i) ++pos;
+            a.splice_after(pos, b);
+            a.push_back(Thing(99));
+            REQUIRE(values_of(a) == deque<int>({0, 1, 2, 3, 4, 10, 11, 12, 99}));
+            REQUIRE(a.size() == 9);
+        }
+        WHEN("a is split after its second link"){
+            LinkedListIterator pos = a.begin();
+            ++pos;
+            LinkedList* rest = a.split_after(pos);
+            THEN("each part has its own links, tail and size"){
+                REQUIRE(n_allocated_links - link_counter == 8);
+                REQUIRE(values_of(a) == deque<int>({0, 1}));
+                REQUIRE(values_of(*rest) == deque<int>({2, 3, 4}));
+                REQUIRE(a.size() == 2);
+                REQUIRE(rest->size() == 3);
+                REQUIRE(a.back().i == 1);
+                REQUIRE(rest->back().i == 4);
+                rest->push_back(Thing(5));
+                a.push_back(Thing(-1));
+                REQUIRE(values_of(*rest) == deque<int>({2, 3, 4, 5}));
+                REQUIRE(values_of(a) == deque<int>({0, 1, -1}));
+            }
+            delete rest;
+        }
+        WHEN("two sorted lists are merged"){
+            LinkedList c;
+            int odds[] = {-1, 1, 3, 3, 20};
+            for(int v : odds) c.push_back(Thing(v));
+            Link* a_three = a.get_link(3);
+            Link* c_three = c.get_link(2);
+            a.merge(c);
+            THEN("the result is sorted, stable and allocation free"){
+                REQUIRE(values_of(a) == deque<int>({-1, 0, 1, 1, 2, 3, 3, 3, 4, 20}));
+                REQUIRE(a.get_link(5) == a_three);
+                REQUIRE(a.get_link(6) == c_three);
+                REQUIRE(n_allocated_links - link_counter == 13);
+                REQUIRE(a.size() == 10);
+                REQUIRE(a.back().i == 20);
+                REQUIRE(c.size() == 0);
+            }
+        }
+        WHEN("lists from different allocators are combined"){
+            LinkArena arena;
+            LinkedList d(arena);
+            d.push_back(Thing(1));
+            REQUIRE_THROWS_AS(a.concat(d), std::invalid_argument);
+            REQUIRE(d.size() == 1);
+        }
+    }
+    GIVEN("A list with an outstanding share() and another list"){
+        LinkedList a, b;
+        for(int i = 0; i < 5; ++i) a.push_back(Thing(i));
+        for(int i = 10; i < 13; ++i) b.push_back(Thing(i));
+        LinkedListIterator pos = a.begin();
+        ++pos;
+        LinkedList* sibling = a.share();
+
+        WHEN("b is concatenated to a"){
+            a.concat(b);
+            THEN("only a changes"){
+                REQUIRE(values_of(a) == deque<int>({0, 1, 2, 3, 4, 10, 11, 12}));
+                REQUIRE(a.back().i == 12);
+                REQUIRE(a.size() == 8);
+                REQUIRE(values_of(*sibling) == deque<int>({0, 1, 2, 3, 4}));
+                REQUIRE(sibling->size() == 5);
+            }
+        }
+        WHEN("b is spliced after an iterator taken before share()"){
+            a.splice_after(pos, b);
+            THEN("the links go into a's own copy"){
+                REQUIRE(values_of(a) == deque<int>({0, 1, 10, 11, 12, 2, 3, 4}));
+                REQUIRE(a.back().i == 4);
+                REQUIRE(values_of(*sibling) == deque<int>({0, 1, 2, 3, 4}));
+            }
+        }
+        WHEN("part of a is spliced within a"){
+            LinkedListIterator last = pos;
+            ++last;
+            ++last;
+            a.splice_after(a.end(), a, pos, last);
+            THEN("only a is reordered"){
+                REQUIRE(values_of(a) == deque<int>({2, 3, 0, 1, 4}));
+                REQUIRE(values_of(*sibling) == deque<int>({0, 1, 2, 3, 4}));
+            }
+        }
+        WHEN("a is split after an iterator taken before share()"){
+            LinkedList* rest = a.split_after(pos);
+            THEN("only a is cut"){
+                REQUIRE(values_of(a) == deque<int>({0, 1}));
+                REQUIRE(a.back().i == 1);
+                REQUIRE(values_of(*rest) == deque<int>({2, 3, 4}));
+                REQUIRE(values_of(*sibling) == deque<int>({0, 1, 2, 3, 4}));
+            }
+            delete rest;
+        }
+        WHEN("a list is merged, concatenated or spliced into itself"){
+            REQUIRE_THROWS_AS(a.concat(a), std::invalid_argument);
+            REQUIRE_THROWS_AS(a.merge(a), std::invalid_argument);
+            REQUIRE_THROWS_AS(a.splice_after(pos, a), std::invalid_argument);
+            THEN("it is left alone"){
+                REQUIRE(values_of(a) == deque<int>({0, 1, 2, 3, 4}));
+                REQUIRE(a.size() == 5);
+            }
+        }
+        delete sibling;
+    }
+}
+
+TEST_CASE("32-finger-and-cursor", "[32]"){
+    GIVEN("A long list"){
+        LinkedList myList;
+        int n = 100000;
+        for(int i = 0; i < n; ++i) myList.push_back(Thing(i));
+
+        THEN("a sequential at() loop walks the list once"){
+            long long sum = 0;
+            for(int i = 0; i < n; ++i) sum += myList.at(i).i;
+            REQUIRE(sum == (long long)n * (n - 1) / 2);
+        }
+        THEN("going back restarts from head"){
+            REQUIRE(myList.at(500).i == 500);
+            REQUIRE(myList.at(10).i == 10);
+            REQUIRE(myList.at(11).i == 11);
+        }
+        WHEN("the list changes between calls"){
+            REQUIRE(myList.at(3).i == 3);
+            myList.push_front(Thing(-1));
+            REQUIRE(myList.at(3).i == 2);
+            myList.pop_front();
+            myList.pop_front();
+            REQUIRE(myList.at(3).i == 4);
+            REQUIRE(myList.at(n - 2).i == n - 1);
+            myList.pop_back();
+            REQUIRE_THROWS_AS(myList.at(n - 2), std::out_of_range);
+            REQUIRE(myList.at(n - 3).i == n - 2);
+            myList.reverse();
+            REQUIRE(myList.at(n - 3).i == 1);
+            myList.sort();
+            REQUIRE(myList.at(n - 3).i == n - 2);
+            LinkedListIterator tenth;
+            tenth.ptr = myList.get_link(9);
+            LinkedList* rest = myList.split_after(tenth);
+            REQUIRE_THROWS_AS(myList.at(10), std::out_of_range);
+            REQUIRE(rest->at(0).i == 11);
+            myList.concat(*rest);
+            REQUIRE(myList.at(10).i == 11);
+            delete rest;
+        }
+        WHEN("callers keep their own cursors"){
+            LinkedListCursor even, odd;
+            long long evens = 0, odds = 0;
+            for(int i = 0; i + 1 < n; i += 2){
+                evens += myList.seek(even, i)->value.i;
+                odds += myList.seek(odd, i + 1)->value.i;
+            }
+            REQUIRE(evens == (long long)(n / 2) * (n / 2 - 1));
+            REQUIRE(odds == evens + n / 2);
+            REQUIRE(even.index == size_t(n - 2));
+            REQUIRE(*odd == Thing(n - 1));
+            ++odd;
+            REQUIRE(odd.link == nullptr);
+        }
+        WHEN("a cursor is held across share()"){
+            LinkedListCursor cursor;
+            REQUIRE(myList.seek(cursor, 2)->value.i == 2);
+            LinkedList* sibling = myList.share();
+            Link* link = myList.seek(cursor, 5);
+            THEN("seek moves it onto the list's own copy of the links"){
+                REQUIRE_FALSE(sibling->is_shared());
+                REQUIRE(link->value.i == 5);
+                REQUIRE(link == myList.get_link(5));
+                REQUIRE(link != sibling->get_link(5));
+                *cursor = Thing(-5);
+                REQUIRE(myList.at(5).i == -5);
+                REQUIRE(sibling->at(5).i == 5);
+                REQUIRE(myList.seek(cursor, 7)->value.i == 7);
+            }
+            delete sibling;
+        }
+    }
+}
+
+// Converts to a Thing, throwing for negative values.
+struct ThrowingSource{
+    int i;
+    operator Thing() const{
+        if(i < 0) throw std::runtime_error("cannot copy");
+        return Thing(i);
+    }
+};
+
+TEST_CASE("33-bulk-append", "[33]"){
+    GIVEN("A list and a range of items"){
+        auto link_counter = n_allocated_links;
+        LinkedList myList;
+        myList.push_back(Thing(-1));
+        Link* old_tail = myList.head;
+        deque<Thing> items;
+        int k = 150;
+        for(int i = 0; i < k; ++i) items.push_back(Thing(i));
+
+        WHEN("the range is appended"){
+            track_links = true;
+            allocated_links = deque<Link*>();
+            myList.append(items.begin(), items.end());
+            track_links = false;
+            THEN("one link per item is allocated and chained after the old tail"){
+                REQUIRE(allocated_links.size() == size_t(k));
+                REQUIRE(n_allocated_links - link_counter == k + 1);
+                REQUIRE(old_tail->next == allocated_links.front());
+                REQUIRE(myList.size() == size_t(k + 1));
+                REQUIRE(myList.back().i == k - 1);
+                for(int i = 0; i < k; ++i){
+                    REQUIRE(myList.at(i + 1).i == i);
+                }
+                myList.push_back(Thing(1000));
+                REQUIRE(allocated_links.back()->next->value.i == 1000);
+            }
+        }
+        WHEN("the range is prepended"){
+            int raw[] = {7, 8, 9};
+            myList.prepend(raw, raw + 3);
+            myList.prepend(items.begin(), items.begin());
+            THEN("the items come first, in order"){
+                REQUIRE(n_allocated_links - link_counter == 4);
+                REQUIRE(myList.size() == 4);
+                REQUIRE(myList.at(0).i == 7);
+                REQUIRE(myList.at(2).i == 9);
+                REQUIRE(myList.get_link(2)->next == old_tail);
+                REQUIRE(myList.back().i == -1);
+            }
+        }
+        WHEN("an empty list on an arena gets a range"){
+            LinkArena arena;
+            LinkedList arenaList(arena);
+            arenaList.append(items.begin(), items.end());
+            arenaList.prepend(items.begin(), items.begin() + 2);
+            REQUIRE(n_allocated_links - link_counter == 1);
+            REQUIRE(arenaList.size() == size_t(k + 2));
+            REQUIRE(arenaList.front().i == 0);
+            REQUIRE(arenaList.at(2).i == 0);
+            REQUIRE(arenaList.back().i == k - 1);
+        }
+    }
+    GIVEN("A range whose items throw partway through a batch"){
+        LinkedList myList;
+        myList.push_back(Thing(-1));
+        auto link_counter = n_allocated_links;
+        ThrowingSource items[100];
+        for(int i = 0; i < 100; ++i) items[i].i = i;
+        int throw_at[] = {3, 70};
+        for(int at : throw_at){
+            items[at].i = -1;
+            REQUIRE_THROWS_AS(myList.append(items, items + 100), std::runtime_error);
+            REQUIRE_THROWS_AS(myList.prepend(items, items + 100), std::runtime_error);
+            UNSCOPED_INFO("neither built links nor unused batch slots may leak");
+            REQUIRE(n_allocated_links == link_counter);
+            REQUIRE(myList.size() == 1);
+            REQUIRE(myList.front().i == -1);
+            items[at].i = at;
+        }
+        myList.append(items, items + 100);
+        REQUIRE(n_allocated_links == link_counter + 100);
+        REQUIRE(myList.back().i == 99);
+    }
+    GIVEN("Link allocation that fails partway through a batch"){
+        LinkedList myList;
+        myList.push_back(Thing(-1));
+        auto link_counter = n_allocated_links;
+        deque<Thing> items;
+        for(int i = 0; i < 100; ++i){
+            items.push_back(Thing(i));
+        }
+        int fail_at[] = {1, 30, 64 + 20};
+        for(int at : fail_at){
+            fail_link_alloc_in = at;
+            REQUIRE_THROWS_AS(myList.append(items.begin(), items.end()), std::bad_alloc);
+            REQUIRE(fail_link_alloc_in == 0);
+            UNSCOPED_INFO("links of the failed batch and of earlier batches are all freed");
+            REQUIRE(n_allocated_links == link_counter);
+            REQUIRE(myList.size() == 1);
+        }
+    }
+}
+
+TEST_CASE("34-prefetching-traversal", "[34]"){
+    GIVEN("A list of 100 items and an empty list"){
+        LinkedList* myList = get_list(100).first;
+        LinkedList empty;
+
+        THEN("the single chain helpers agree with a plain walk"){
+            long total = 0;
+            for (Thing& t : *myList) total += t.i;
+            long seen = 0;
+            chain_for_each(myList->head, [&](Thing& t){ seen += t.i; });
+            REQUIRE(seen == total);
+            REQUIRE(chain_accumulate(myList->head, 0L, [](long acc, const Thing& t){ return acc + t.i; }) == total);
+            REQUIRE(chain_count_if(myList->head, [](const Thing& t){ return t.i % 20 == 0; }) == 50);
+            REQUIRE(chain_find(myList->head, [](const Thing& t){ return t.i == 420; }) == myList->get_link(57));
+            REQUIRE(chain_find(myList->head, [](const Thing& t){ return t.i == 421; }) == nullptr);
+
+            REQUIRE(chain_accumulate(empty.head, 7, [](int acc, const Thing&){ return acc + 1; }) == 7);
+            REQUIRE(chain_find(empty.head, [](const Thing&){ return true; }) == nullptr);
+        }
+        THEN("chain_for_each may modify the items in order"){
+            int next = 0;
+            chain_for_each(myList->head, [&](Thing& t){ t.i = next++; });
+            REQUIRE(myList->front().i == 0);
+            REQUIRE(myList->back().i == 99);
+        }
+        WHEN("more chains than lockstep_width are walked in lock-step"){
+            const size_t n = lockstep_width + 5;
+            LinkedList lists[n];
+            Link* heads[n];
+            long expected[n];
+            for (size_t c = 0; c < n; ++c){
+                for (size_t k = 0; k < c % 7; ++k){
+                    lists[c].push_back(Thing(int(c * 100 + k)));
+                }
+                heads[c] = lists[c].head;
+                expected[c] = 0;
+                for (Thing& t : lists[c]) expected[c] += t.i;
+            }
+            long sums[n];
+            for (size_t c = 0; c < n; ++c) sums[c] = 1;
+            chains_accumulate(heads, n, sums, [](long acc, const Thing& t){ return acc + t.i; });
+
+            int last[n];
+            bool in_order = true;
+            size_t visits = 0;
+            for (size_t c = 0; c < n; ++c) last[c] = -1;
+            chains_for_each(heads, n, [&](size_t c, Thing& t){
+                in_order = in_order && t.i / 100 == int(c) && t.i > last[c];
+                last[c] = t.i;
+                ++visits;
+            });
+            THEN("every chain is visited fully and in its own order"){
+                size_t total = 0;
+                for (size_t c = 0; c < n; ++c){
+                    REQUIRE(sums[c] == expected[c] + 1);
+                    total += c % 7;
+                }
+                REQUIRE(in_order);
+                REQUIRE(visits == total);
+            }
+        }
+        delete myList;
+    }
+}
+
+bool runs_forwards(LinkedList& list){
+    for (Link* curr = list.head; curr != nullptr && curr->next != nullptr; curr = curr->next){
+        if (curr->next < curr) return false;
+    }
+    return true;
+}
+
+TEST_CASE("35-compact", "[35]"){
+    GIVEN("A list built by pushing to the front, so it runs backwards through memory"){
+        LinkedList* myList;
+        deque<Link*> links;
+        tie(myList, links) = get_list(100);
+        auto link_counter = n_allocated_links;
+        REQUIRE_FALSE(runs_forwards(*myList));
+        REQUIRE(myList->fragmentation() > 0);
+
+        WHEN("the list is compacted"){
+            myList->compact();
+            THEN("the items are unchanged and the links run forwards through memory"){
+                REQUIRE(myList->size() == 100);
+                REQUIRE(n_allocated_links == link_counter);
+                for (int i = 0; i < 100; ++i){
+                    REQUIRE(myList->at(i).i == (99 - i) * 10);
+                }
+                REQUIRE(runs_forwards(*myList));
+                for (Link* old : links){
+                    REQUIRE_FALSE(still_allocated[old]);
+                }
+                myList->push_back(Thing(1));
+                REQUIRE(myList->back().i == 1);
+                REQUIRE(myList->size() == 101);
+            }
+        }
+        WHEN("auto compaction is on and the list keeps changing"){
+            myList->set_auto_compact(0.01);
+            for (int i = 0; i < 49; ++i){
+                myList->push_back(Thing(-i));
+                myList->pop_back();
+            }
+            REQUIRE(myList->head == links.front());
+            myList->push_back(Thing(-1));
+            myList->pop_back();
+            THEN("it is compacted after size() updates"){
+                REQUIRE(myList->head != links.front());
+                REQUIRE(runs_forwards(*myList));
+                REQUIRE(myList->size() == 100);
+                REQUIRE(myList->front().i == 990);
+                REQUIRE(myList->back().i == 0);
+                REQUIRE(n_allocated_links == link_counter);
+            }
+        }
+        WHEN("auto compaction is off"){
+            for (int i = 0; i < 300; ++i){
+                myList->push_back(Thing(-i));
+                myList->pop_back();
+            }
+            THEN("the links stay where they are"){
+                REQUIRE(myList->head == links.front());
+                REQUIRE_FALSE(runs_forwards(*myList));
+            }
+        }
+        delete myList;
+    }
+    GIVEN("A list on an arena and an empty list"){
+        LinkArena arena;
+        LinkedList arenaList(arena);
+        for (int i = 0; i < 50; ++i){
+            arenaList.push_front(Thing(i));
+        }
+        LinkedList empty;
+        empty.compact();
+        REQUIRE(empty.head == nullptr);
+        REQUIRE(empty.fragmentation() == 0);
+
+        arenaList.compact();
+        THEN("the arena list is one contiguous block in list order"){
+            REQUIRE(arenaList.fragmentation() == 0);
+            for (int i = 0; i + 1 < 50; ++i){
+                REQUIRE(arenaList.get_link(i + 1) == arenaList.get_link(i) + 1);
+                REQUIRE(arenaList.at(i).i == 49 - i);
+            }
+            REQUIRE(arenaList.back().i == 0);
+        }
+    }
+}
@@ -0,0 +1,169 @@
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <cstddef>
+#include "linkedlist.h"
+
+// Read loops over a chain of links that prefetch ahead of the walk.
+//
+//   Following next is a dependent load, so a plain walk over links scattered
+//   in memory waits for one cache miss per link. These helpers ask for
+//   next->next while the current link is being worked on, so the miss for the
+//   link after next overlaps with the work for this one. Each takes the first
+//   link of a chain, such as LinkedList::head, and stops at nullptr.
+//
+//   The lock-step versions walk several independent chains one link at a
+//   time each, so the misses of up to lockstep_width chains are in flight
+//   together. Use them to walk many short lists, or a long list whose
+//   sublists are known, e.g. a hash table's buckets.
+//
+//   Nothing here unshares a LinkedList made by share(); call unshare() first
+//   when f modifies the items.
+
+static const size_t lockstep_width = 16;  // Chains walked together at most
+
+/**
+ * @brief prefetch_link
+ * Hint that link will be read soon. Does nothing for nullptr or without GCC builtins.
+ */
+inline void prefetch_link(const Link* link)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(link, 0, 3);
+#else
+    (void)link;
+#endif
+}
+
+/**
+ * @brief chain_for_each
+ * @param first The first link, may be nullptr
+ * @param f Called as f(Thing&) for every item in order
+ */
+template<class F>
+void chain_for_each(Link* first, F f)
+{
+    for (Link* curr = first; curr != nullptr; ){
+        Link* next = curr->next;
+        if (next != nullptr){
+            prefetch_link(next->next);
+        }
+        f(curr->value);
+        curr = next;
+    }
+}
+
+/**
+ * @brief chain_find
+ * @param first The first link, may be nullptr
+ * @param pred Called as pred(const Thing&)
+ * @return The first link whose item satisfies pred, or nullptr
+ */
+template<class Pred>
+Link* chain_find(Link* first, Pred pred)
+{
+    for (Link* curr = first; curr != nullptr; ){
+        Link* next = curr->next;
+        if (next != nullptr){
+            prefetch_link(next->next);
+        }
+        if (pred(static_cast<const Thing&>(curr->value))){
+            return curr;
+        }
+        curr = next;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief chain_count_if
+ * @param first The first link, may be nullptr
+ * @param pred Called as pred(const Thing&)
+ * @return The number of items that satisfy pred
+ */
+template<class Pred>
+size_t chain_count_if(Link* first, Pred pred)
+{
+    size_t n = 0;
+    chain_for_each(first, [&](Thing& t){
+        if (pred(static_cast<const Thing&>(t))){
+            ++n;
+        }
+    });
+    return n;
+}
+
+/**
+ * @brief chain_accumulate
+ * @param first The first link, may be nullptr
+ * @param init
+ * @param op Called as acc = op(acc, const Thing&) for every item in order
+ * @return The final acc
+ */
+template<class T, class Op>
+T chain_accumulate(Link* first, T init, Op op)
+{
+    chain_for_each(first, [&](Thing& t){
+        init = op(init, static_cast<const Thing&>(t));
+    });
+    return init;
+}
+
+/**
+ * @brief chains_for_each
+ * @param firsts The first link of each chain, any of them may be nullptr
+ * @param n_chains
+ * @param f Called as f(chain index, Thing&) for every item. Each chain is
+ * visited in order, but items of different chains interleave.
+ * Chains are taken lockstep_width at a time. Each round moves every chain
+ * of the group that has not ended on by one link and prefetches its next
+ * link, which then has the rest of the round to arrive.
+ */
+template<class F>
+void chains_for_each(Link* const* firsts, size_t n_chains, F f)
+{
+    for (size_t base = 0; base < n_chains; base += lockstep_width){
+        size_t width = n_chains - base < lockstep_width ? n_chains - base : lockstep_width;
+        Link* curr[lockstep_width];
+        size_t live = 0;
+        for (size_t j = 0; j < width; ++j){
+            curr[j] = firsts[base + j];
+            prefetch_link(curr[j]);
+            live += curr[j] != nullptr;
+        }
+        while (live != 0){
+            for (size_t j = 0; j < width; ++j){
+                Link* link = curr[j];
+                if (link == nullptr){
+                    continue;
+                }
+                Link* next = link->next;
+                if (next != nullptr){
+                    prefetch_link(next);
+                }
+                else{
+                    --live;
+                }
+                f(base + j, link->value);
+                curr[j] = next;
+            }
+        }
+    }
+}
+
+/**
+ * @brief chains_accumulate
+ * @param firsts The first link of each chain, any of them may be nullptr
+ * @param n_chains
+ * @param accs Holds the starting value for each chain, replaced by its result
+ * @param op Called as acc = op(acc, const Thing&) for every item
+ */
+template<class T, class Op>
+void chains_accumulate(Link* const* firsts, size_t n_chains, T* accs, Op op)
+{
+    chains_for_each(firsts, n_chains, [&](size_t c, Thing& t){
+        accs[c] = op(accs[c], static_cast<const Thing&>(t));
+    });
+}
+
+#endif // TRAVERSAL_H
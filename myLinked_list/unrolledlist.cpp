@@ -0,0 +1,378 @@
+#include "unrolledlist.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/**
+ * @brief UnrolledNode::operator new
+ * @param sz
+ * @return Memory for one node, aligned to alignof(UnrolledNode)
+ */
+void *UnrolledNode::operator new(size_t sz)
+{
+#ifdef _WIN32
+    void *raw = _aligned_malloc(sz, alignof(UnrolledNode));
+    if (raw == nullptr){
+        throw std::bad_alloc();
+    }
+#else
+    void *raw = nullptr;
+    if (posix_memalign(&raw, alignof(UnrolledNode), sz) != 0){
+        throw std::bad_alloc();
+    }
+#endif
+    return raw;
+}
+
+/**
+ * @brief UnrolledNode::operator delete
+ * @param ptr Memory from UnrolledNode::operator new, may be nullptr
+ */
+void UnrolledNode::operator delete(void *ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+/**
+ * @brief UnrolledListIterator::operator*
+ * @return Return a reference to the thing we're pointing to
+ */
+Thing &UnrolledListIterator::operator*()
+{
+    return node->items[index];
+}
+
+/**
+ * @brief UnrolledListIterator::operator++
+ * Move to the next thing, stepping to the next node at the end of this one.
+ * @return Return a reference to this object.
+ */
+UnrolledListIterator &UnrolledListIterator::operator++()
+{
+    if (++index == node->count){
+        node = node->next;
+        index = 0;
+    }
+    return *this;
+}
+
+/**
+ * @brief UnrolledList::UnrolledList
+ * Construct an empty list with no nodes.
+ */
+UnrolledList::UnrolledList()
+{
+}
+
+/**
+ * @brief UnrolledList::~UnrolledList
+ * Free every node.
+ */
+UnrolledList::~UnrolledList()
+{
+    while (head != nullptr){
+        UnrolledNode *next = head->next;
+        delete head;
+        head = next;
+    }
+}
+
+/**
+ * @brief UnrolledList::push_front
+ * @param t
+ * Push t to the front of the list, starting a new node if the first one is full.
+ */
+void UnrolledList::push_front(Thing t)
+{
+    if (head == nullptr || head->count == UnrolledNode::capacity){
+        UnrolledNode *node = new UnrolledNode;
+        node->next = head;
+        head = node;
+        if (tail == nullptr){
+            tail = node;
+        }
+    }
+    for (unsigned j = head->count; j > 0; --j){
+        head->items[j] = head->items[j - 1];
+    }
+    head->items[0] = t;
+    ++head->count;
+    ++count;
+}
+
+/**
+ * @brief UnrolledList::pop_front
+ * Remove the front item in the list. Never called on an empty list.
+ */
+void UnrolledList::pop_front()
+{
+    erase(0);
+}
+
+/**
+ * @brief UnrolledList::push_back
+ * @param t
+ * Add t to the back of the list, starting a new node if the last one is full.
+ * Filling nodes completely keeps a list built by push_back densely packed.
+ */
+void UnrolledList::push_back(Thing t)
+{
+    if (tail == nullptr || tail->count == UnrolledNode::capacity){
+        UnrolledNode *node = new UnrolledNode;
+        if (tail == nullptr){
+            head = node;
+        }
+        else{
+            tail->next = node;
+        }
+        tail = node;
+    }
+    tail->items[tail->count++] = t;
+    ++count;
+}
+
+/**
+ * @brief UnrolledList::pop_back
+ * Remove the last item in the list. Never called on an empty list.
+ * Only walks the nodes when the last node becomes empty.
+ */
+void UnrolledList::pop_back()
+{
+    --count;
+    if (--tail->count > 0){
+        return;
+    }
+    UnrolledNode *prev = nullptr;
+    for (UnrolledNode *curr = head; curr != tail; curr = curr->next){
+        prev = curr;
+    }
+    remove_node(tail, prev);
+}
+
+/**
+ * @brief UnrolledList::size
+ * @return number of items in the list
+ */
+size_t UnrolledList::size()
+{
+    return count;
+}
+
+/**
+ * @brief UnrolledList::node_count
+ * @return number of nodes holding the items
+ */
+size_t UnrolledList::node_count()
+{
+    size_t n = 0;
+    for (UnrolledNode *curr = head; curr != nullptr; curr = curr->next){
+        ++n;
+    }
+    return n;
+}
+
+/**
+ * @brief UnrolledList::front
+ * @return a reference to the first item in the list
+ */
+Thing &UnrolledList::front()
+{
+    return head->items[0];
+}
+
+/**
+ * @brief UnrolledList::back
+ * @return a reference to the last item in the list
+ */
+Thing &UnrolledList::back()
+{
+    return tail->items[tail->count - 1];
+}
+
+/**
+ * @brief UnrolledList::at
+ * @param i
+ * @return A reference to the thing at index i
+ * @throws std::out_of_range("i out of bounds")
+ */
+Thing &UnrolledList::at(size_t i)
+{
+    if (i >= count){
+        throw std::out_of_range("i out of bounds");
+    }
+    UnrolledNode *prev;
+    UnrolledNode *node = find(i, prev);
+    return node->items[i];
+}
+
+/**
+ * @brief UnrolledList::insert
+ * @param i Index the new thing will have, at most size()
+ * @param t
+ * Shifts later things in the same node up by one, splitting the node first if it is full.
+ * @throws std::out_of_range("i out of bounds")
+ */
+void UnrolledList::insert(size_t i, Thing t)
+{
+    if (i > count){
+        throw std::out_of_range("i out of bounds");
+    }
+    if (i == count){
+        push_back(t);
+        return;
+    }
+    UnrolledNode *prev;
+    UnrolledNode *node = find(i, prev);
+    if (node->count == UnrolledNode::capacity){
+        split(node);
+        if (i > node->count){
+            i -= node->count;
+            node = node->next;
+        }
+    }
+    for (unsigned j = node->count; j > i; --j){
+        node->items[j] = node->items[j - 1];
+    }
+    node->items[i] = t;
+    ++node->count;
+    ++count;
+}
+
+/**
+ * @brief UnrolledList::erase
+ * @param i
+ * Remove the thing at index i. A node left less than half full takes in its
+ * successor when both fit in one node.
+ * @throws std::out_of_range("i out of bounds")
+ */
+void UnrolledList::erase(size_t i)
+{
+    if (i >= count){
+        throw std::out_of_range("i out of bounds");
+    }
+    UnrolledNode *prev;
+    UnrolledNode *node = find(i, prev);
+    for (unsigned j = unsigned(i) + 1; j < node->count; ++j){
+        node->items[j - 1] = node->items[j];
+    }
+    --node->count;
+    --count;
+
+    if (node->count == 0){
+        remove_node(node, prev);
+        return;
+    }
+    UnrolledNode *next = node->next;
+    if (node->count < UnrolledNode::capacity / 2 && next != nullptr
+            && node->count + next->count <= UnrolledNode::capacity){
+        for (unsigned j = 0; j < next->count; ++j){
+            node->items[node->count + j] = next->items[j];
+        }
+        node->count += next->count;
+        remove_node(next, node);
+    }
+}
+
+/**
+ * @brief UnrolledList::splice_back
+ * @param other
+ * Move every node of other to the end of this list in O(1). other is left empty.
+ */
+void UnrolledList::splice_back(UnrolledList &other)
+{
+    if (other.head == nullptr || &other == this){
+        return;
+    }
+    if (tail == nullptr){
+        head = other.head;
+    }
+    else{
+        tail->next = other.head;
+    }
+    tail = other.tail;
+    count += other.count;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.count = 0;
+}
+
+/**
+ * @brief UnrolledList::begin
+ * @return an iterator referencing the first item
+ */
+UnrolledListIterator UnrolledList::begin()
+{
+    UnrolledListIterator iter;
+    iter.node = head;
+    return iter;
+}
+
+/**
+ * @brief UnrolledList::end
+ * @return an iterator representing one past the last item
+ */
+UnrolledListIterator UnrolledList::end()
+{
+    return UnrolledListIterator();
+}
+
+/**
+ * Find the node holding index i, skipping whole nodes by their counts.
+ * On return i is the position inside that node and prev is the node before it.
+ */
+UnrolledNode *UnrolledList::find(size_t &i, UnrolledNode *&prev)
+{
+    prev = nullptr;
+    UnrolledNode *node = head;
+    while (i >= node->count){
+        i -= node->count;
+        prev = node;
+        node = node->next;
+    }
+    return node;
+}
+
+/**
+ * Move the upper half of a full node into a new node right after it.
+ */
+void UnrolledList::split(UnrolledNode *node)
+{
+    UnrolledNode *upper = new UnrolledNode;
+    unsigned keep = node->count / 2;
+    for (unsigned j = keep; j < node->count; ++j){
+        upper->items[j - keep] = node->items[j];
+    }
+    upper->count = node->count - keep;
+    node->count = keep;
+
+    upper->next = node->next;
+    node->next = upper;
+    if (tail == node){
+        tail = upper;
+    }
+}
+
+/**
+ * Unlink node, whose predecessor is prev (nullptr for the head), and free it.
+ */
+void UnrolledList::remove_node(UnrolledNode *node, UnrolledNode *prev)
+{
+    if (prev == nullptr){
+        head = node->next;
+    }
+    else{
+        prev->next = node->next;
+    }
+    if (tail == node){
+        tail = prev;
+    }
+    delete node;
+}
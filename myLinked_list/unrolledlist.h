@@ -0,0 +1,81 @@
+#ifndef UNROLLEDLIST_H
+#define UNROLLEDLIST_H
+
+#include "linkedlist.h"
+
+// Node of an UnrolledList: a small array of things sized so the whole node
+//   fills two cache lines. Nodes are cache line aligned, so a node never
+//   straddles a third line; operator new makes sure of that, as plain new
+//   does not honour alignas before C++17. Nodes in a list are never empty.
+class alignas(64) UnrolledNode{
+public:
+   static const size_t capacity = (128 - sizeof(void*) - sizeof(unsigned)) / sizeof(Thing);
+
+   UnrolledNode *next = nullptr;
+   unsigned count = 0;
+   Thing items[capacity];
+
+   void* operator new(size_t sz);
+   void operator delete(void* ptr);
+};
+
+
+// Iterator for UnrolledList
+class UnrolledListIterator{
+public:
+   UnrolledNode *node = nullptr; // Node holding the current thing
+   unsigned index = 0;           // Position of the current thing in node
+
+   Thing& operator*();                 // Dereference
+   UnrolledListIterator& operator++(); // Increment
+
+   bool operator !=(const UnrolledListIterator& other) const{
+       return node != other.node || index != other.index;
+   }
+};
+
+
+// Linked list that keeps up to UnrolledNode::capacity things per node.
+//   Walking it touches one cache miss per node instead of one per thing,
+//   and at(i) skips whole nodes. Full nodes split in half on insert and
+//   half empty nodes merge with their successor on erase.
+class UnrolledList{
+public:
+   UnrolledList();
+   ~UnrolledList();
+
+   UnrolledList(const UnrolledList&) = delete;
+   UnrolledList& operator=(const UnrolledList&) = delete;
+
+   void push_front(Thing t);
+   void pop_front();
+
+   void push_back(Thing t);
+   void pop_back();
+
+   size_t size();
+   size_t node_count();
+
+   Thing& front();
+   Thing& back();
+   Thing& at(size_t i);
+
+   void insert(size_t i, Thing t);
+   void erase(size_t i);
+
+   void splice_back(UnrolledList& other);
+
+   UnrolledListIterator begin();
+   UnrolledListIterator end();
+
+private:
+   UnrolledNode *find(size_t& i, UnrolledNode*& prev);
+   void split(UnrolledNode *node);
+   void remove_node(UnrolledNode *node, UnrolledNode *prev);
+
+   UnrolledNode *head = nullptr;
+   UnrolledNode *tail = nullptr;
+   size_t count = 0;
+};
+
+#endif // UNROLLEDLIST_H
@@ -1,13 +1,20 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += myvector.cpp \
+    ringbuffer.cpp \
+    spscqueue.cpp \
+    flathashmap.cpp \
     tests.cpp
 
 HEADERS += \
-    myvector.h
+    myvector.h \
+    heap.h \
+    flathashmap.h \
+    ringbuffer.h \
+    spscqueue.h
 
 win32 {
     QMAKE_CXXFLAGS += -Wa,-mbig-obj
@@ -0,0 +1,115 @@
+// Insert, lookup and erase of random int keys in FlatHashMap compared with
+//   Tree from the BST project and std::unordered_map.
+//   Usage: bench_hashmap [keys]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+#include "flathashmap.h"
+#include "../myBST/tree.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double ns_per_op(Clock::time_point start, size_t ops)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+static void report(const char* name, double insert, double hit, double miss, double erase, long long check)
+{
+    std::cout << name << ": insert " << insert << " ns, hit " << hit
+              << " ns, miss " << miss << " ns";
+    if (erase >= 0){
+        std::cout << ", erase " << erase << " ns";
+    }
+    std::cout << " (check " << check << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::mt19937 rng(42);
+    int* keys = new int[n];
+    int* misses = new int[n];
+    for (size_t i = 0; i < n; ++i){
+        keys[i] = int(rng() >> 1);
+        misses[i] = -int(rng() >> 1) - 1;
+    }
+
+    {
+        FlatHashMap map;
+        map.reserve(n);
+        long long check = 0;
+        Clock::time_point t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            map.insert(keys[i], int(i));
+        }
+        double insert = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.contains(keys[i]);
+        }
+        double hit = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.contains(misses[i]);
+        }
+        double miss = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.erase(keys[i]);
+        }
+        report("FlatHashMap", insert, hit, miss, ns_per_op(t, n), check);
+    }
+    {
+        std::unordered_map<int, int> map;
+        map.reserve(n);
+        long long check = 0;
+        Clock::time_point t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            map.insert(std::make_pair(keys[i], int(i)));
+        }
+        double insert = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.count(keys[i]);
+        }
+        double hit = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.count(misses[i]);
+        }
+        double miss = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += map.erase(keys[i]);
+        }
+        report("std::unordered_map", insert, hit, miss, ns_per_op(t, n), check);
+    }
+    {
+        Tree tree;
+        long long check = 0;
+        Clock::time_point t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            tree.insert(keys[i]);
+        }
+        double insert = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += tree.contains(keys[i]);
+        }
+        double hit = ns_per_op(t, n);
+        t = Clock::now();
+        for (size_t i = 0; i < n; ++i){
+            check += tree.contains(misses[i]);
+        }
+        double miss = ns_per_op(t, n);
+        report("Tree", insert, hit, miss, -1, check);
+    }
+
+    delete [] keys;
+    delete [] misses;
+    return 0;
+}
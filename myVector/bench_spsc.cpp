@@ -0,0 +1,126 @@
+// Throughput and latency of SpscQueue between two threads pinned to
+//   different cores. Usage: bench_spsc [items] [producer_cpu] [consumer_cpu]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "spscqueue.h"
+
+bool Thing::verbose = false;
+size_t Thing::last_alloc = 0;
+
+using Clock = std::chrono::steady_clock;
+
+static void pin_to_cpu(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0){
+        std::cerr << "could not pin to cpu " << cpu << std::endl;
+    }
+#else
+    (void) cpu;
+#endif
+}
+
+static double throughput(size_t items, size_t batch, int producer_cpu, int consumer_cpu)
+{
+    SpscQueue q(4096);
+    Thing* in = new Thing[batch];
+    Thing* out = new Thing[batch];
+    long long sum = 0;
+
+    std::thread consumer([&]{
+        pin_to_cpu(consumer_cpu);
+        size_t received = 0;
+        while (received < items){
+            size_t n = q.try_pop_n(out, batch);
+            for (size_t i = 0; i < n; ++i){
+                sum += out[i].i;
+            }
+            received += n;
+        }
+    });
+
+    pin_to_cpu(producer_cpu);
+    Clock::time_point start = Clock::now();
+    size_t sent = 0;
+    while (sent < items){
+        size_t n = std::min(batch, items - sent);
+        for (size_t i = 0; i < n; ++i){
+            in[i].i = int(sent + i);
+        }
+        size_t pushed = 0;
+        while (pushed < n){
+            pushed += q.try_push_n(in + pushed, n - pushed);
+        }
+        sent += n;
+    }
+    consumer.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    long long expected = (long long)items * (items - 1) / 2;
+    if (sum != expected){
+        std::cerr << "checksum mismatch" << std::endl;
+    }
+    delete [] in;
+    delete [] out;
+    return items / seconds;
+}
+
+static double round_trip_ns(size_t trips, int producer_cpu, int consumer_cpu)
+{
+    SpscQueue ping(64);
+    SpscQueue pong(64);
+
+    std::thread echo([&]{
+        pin_to_cpu(consumer_cpu);
+        Thing t;
+        for (size_t i = 0; i < trips; ++i){
+            while (!ping.try_pop(t)){}
+            while (!pong.try_push(t)){}
+        }
+    });
+
+    pin_to_cpu(producer_cpu);
+    Thing t;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < trips; ++i){
+        t.i = int(i);
+        while (!ping.try_push(t)){}
+        while (!pong.try_pop(t)){}
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    echo.join();
+    return ns / trips;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+    int producer_cpu = argc > 2 ? std::atoi(argv[2]) : 0;
+    int consumer_cpu = argc > 3 ? std::atoi(argv[3]) : 1;
+    if (std::thread::hardware_concurrency() < 2){
+        std::cerr << "needs at least two cores, both sides spin" << std::endl;
+        return 1;
+    }
+
+    size_t batches[] = {1, 8, 64, 256};
+    for (size_t batch : batches){
+        double rate = throughput(items, batch, producer_cpu, consumer_cpu);
+        std::cout << "throughput batch=" << batch << ": "
+                  << rate / 1e6 << " M things/s" << std::endl;
+    }
+    double rtt = round_trip_ns(items / 20, producer_cpu, consumer_cpu);
+    std::cout << "latency: " << rtt << " ns round trip, "
+              << rtt / 2 << " ns one way" << std::endl;
+    return 0;
+}
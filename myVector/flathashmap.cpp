@@ -0,0 +1,353 @@
+#include "flathashmap.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const int8_t ctrl_empty = -128;
+static const int8_t ctrl_deleted = -2;
+static const size_t npos = size_t(-1);
+
+/**
+ * @brief match_byte
+ * @return A bitmask with bit i set if group[i] == b
+ */
+static inline uint32_t match_byte(const int8_t* group, int8_t b)
+{
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(b))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatHashMap::group_size; ++i){
+        mask |= uint32_t(group[i] == b) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief match_empty_or_deleted
+ * @return A bitmask with bit i set if group[i] is not a full slot.
+ * Both markers are negative and tags are not, so this is just the sign bits.
+ */
+static inline uint32_t match_empty_or_deleted(const int8_t* group)
+{
+#ifdef __SSE2__
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return uint32_t(_mm_movemask_epi8(ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < FlatHashMap::group_size; ++i){
+        mask |= uint32_t(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief lowest_bit
+ * @return The index of the lowest set bit in a non zero mask
+ */
+static inline unsigned lowest_bit(uint32_t mask)
+{
+#if defined(__GNUC__)
+    return unsigned(__builtin_ctz(mask));
+#else
+    unsigned i = 0;
+    while ((mask & 1) == 0){
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+/**
+ * @brief FlatHashMap::FlatHashMap Construct an empty map without any slots
+ */
+FlatHashMap::FlatHashMap() : FlatHashMap(true)
+{
+}
+
+/**
+ * @brief FlatHashMap::FlatHashMap Construct an empty table without any slots
+ * @param store_values false for a set, the value buffer is then never allocated
+ */
+FlatHashMap::FlatHashMap(bool store_values)
+    : ctrl(nullptr), keys(MyVector::cache_line_size), values(MyVector::cache_line_size),
+      n_items(0), n_slots(0), growth_left(0), store_values(store_values)
+{
+}
+
+/**
+ * @brief FlatHashMap::~FlatHashMap Free the control bytes, MyVector frees the rest
+ */
+FlatHashMap::~FlatHashMap()
+{
+    delete [] ctrl;
+}
+
+/**
+ * @brief FlatHashMap::size
+ * @return The number of keys in the map
+ */
+size_t FlatHashMap::size() const
+{
+    return n_items;
+}
+
+/**
+ * @brief FlatHashMap::empty
+ * @return true if there are no keys in the map
+ */
+bool FlatHashMap::empty() const
+{
+    return n_items == 0;
+}
+
+/**
+ * @brief FlatHashMap::capacity
+ * @return The number of slots. At most 7/8 of them are filled before a rehash.
+ */
+size_t FlatHashMap::capacity() const
+{
+    return n_slots;
+}
+
+/**
+ * @brief FlatHashMap::insert
+ * @param key
+ * @param value
+ * @return true if key was added, false if it was already there (its value is left alone)
+ */
+bool FlatHashMap::insert(int key, int value)
+{
+    uint64_t h = hash(key);
+    if (find_slot(key, h) != npos){
+        return false;
+    }
+    size_t slot = insert_slot(key, h);
+    if (store_values){
+        values[slot].i = value;
+    }
+    return true;
+}
+
+/**
+ * @brief FlatHashMap::operator []
+ * @param key
+ * @return A reference to the value for key, which is added with value 0 if missing.
+ * The reference is invalidated by the next insert.
+ */
+int &FlatHashMap::operator[](int key)
+{
+    uint64_t h = hash(key);
+    size_t slot = find_slot(key, h);
+    if (slot == npos){
+        slot = insert_slot(key, h);
+        values[slot].i = 0;
+    }
+    return values[slot].i;
+}
+
+/**
+ * @brief FlatHashMap::find
+ * @param key
+ * @return A pointer to the value for key or nullptr if key is not in the map
+ */
+int *FlatHashMap::find(int key)
+{
+    size_t slot = find_slot(key, hash(key));
+    return slot == npos ? nullptr : &values[slot].i;
+}
+
+/**
+ * @brief FlatHashMap::contains
+ * @param key
+ * @return true if key is in the map
+ */
+bool FlatHashMap::contains(int key)
+{
+    return find_slot(key, hash(key)) != npos;
+}
+
+/**
+ * @brief FlatHashMap::erase
+ * @param key
+ * @return true if key was in the map and has been removed
+ */
+bool FlatHashMap::erase(int key)
+{
+    size_t slot = find_slot(key, hash(key));
+    if (slot == npos){
+        return false;
+    }
+    const int8_t* group = ctrl + (slot & ~(group_size - 1));
+    if (match_byte(group, ctrl_empty) != 0){
+        ctrl[slot] = ctrl_empty;
+        ++growth_left;
+    }
+    else{
+        ctrl[slot] = ctrl_deleted;
+    }
+    --n_items;
+    return true;
+}
+
+/**
+ * @brief FlatHashMap::reserve
+ * @param n
+ * Make room for n keys so that inserting them does not rehash.
+ */
+void FlatHashMap::reserve(size_t n)
+{
+    size_t slots = group_size;
+    while (slots / 8 * 7 < n){
+        slots *= 2;
+    }
+    if (slots > n_slots){
+        rehash(slots);
+    }
+}
+
+/**
+ * @brief FlatHashMap::clear
+ * Remove every key but keep the slots.
+ */
+void FlatHashMap::clear()
+{
+    if (ctrl != nullptr){
+        std::memset(ctrl, ctrl_empty, n_slots);
+    }
+    n_items = 0;
+    growth_left = n_slots / 8 * 7;
+}
+
+/**
+ * Mix the bits of key. The low 7 bits become the slot's tag,
+ * the rest pick the first group to probe.
+ */
+uint64_t FlatHashMap::hash(int key)
+{
+    uint64_t h = uint64_t(uint32_t(key)) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+}
+
+/**
+ * Probe group by group for key, stopping at the first group with an empty slot.
+ * Groups are visited at triangular offsets, which reaches every group because
+ * the number of groups is a power of two.
+ * Returns the slot of key or npos.
+ */
+size_t FlatHashMap::find_slot(int key, uint64_t h)
+{
+    if (n_slots == 0){
+        return npos;
+    }
+    int8_t tag = int8_t(h & 0x7F);
+    size_t group_mask = n_slots / group_size - 1;
+    size_t g = size_t(h >> 7) & group_mask;
+    for (size_t step = 1; ; ++step){
+        const int8_t* group = ctrl + g * group_size;
+        uint32_t candidates = match_byte(group, tag);
+        while (candidates != 0){
+            size_t slot = g * group_size + lowest_bit(candidates);
+            if (keys[slot].i == key){
+                return slot;
+            }
+            candidates &= candidates - 1;
+        }
+        if (match_byte(group, ctrl_empty) != 0){
+            return npos;
+        }
+        g = (g + step) & group_mask;
+    }
+}
+
+/**
+ * Claim the first empty or deleted slot on key's probe sequence and store key.
+ * key must not already be in the map. Rehashes first when no empty slot may be used.
+ * Returns the slot.
+ */
+size_t FlatHashMap::insert_slot(int key, uint64_t h)
+{
+    if (growth_left == 0){
+        // Mostly tombstones: clean up in place, otherwise double.
+        if (n_slots != 0 && n_items <= n_slots / 16 * 7){
+            rehash(n_slots);
+        }
+        else{
+            rehash(n_slots == 0 ? group_size : n_slots * 2);
+        }
+    }
+    size_t group_mask = n_slots / group_size - 1;
+    size_t g = size_t(h >> 7) & group_mask;
+    for (size_t step = 1; ; ++step){
+        uint32_t free_slots = match_empty_or_deleted(ctrl + g * group_size);
+        if (free_slots != 0){
+            size_t slot = g * group_size + lowest_bit(free_slots);
+            if (ctrl[slot] == ctrl_empty){
+                --growth_left;
+            }
+            ctrl[slot] = int8_t(h & 0x7F);
+            keys[slot].i = key;
+            ++n_items;
+            return slot;
+        }
+        g = (g + step) & group_mask;
+    }
+}
+
+/**
+ * Move every key into a fresh table of new_capacity slots, dropping tombstones.
+ */
+void FlatHashMap::rehash(size_t new_capacity)
+{
+    int8_t* old_ctrl = ctrl;
+    size_t old_slots = n_slots;
+    MyVector old_keys(MyVector::cache_line_size);
+    MyVector old_values(MyVector::cache_line_size);
+    old_keys.swap(keys);
+    old_values.swap(values);
+
+    ctrl = new int8_t[new_capacity];
+    std::memset(ctrl, ctrl_empty, new_capacity);
+    keys.reserve(new_capacity);
+    if (store_values){
+        values.reserve(new_capacity);
+    }
+    n_slots = new_capacity;
+    n_items = 0;
+    growth_left = new_capacity / 8 * 7;
+
+    for (size_t i = 0; i < old_slots; ++i){
+        if (old_ctrl[i] >= 0){
+            int key = old_keys[i].i;
+            size_t slot = insert_slot(key, hash(key));
+            if (store_values){
+                values[slot].i = old_values[i].i;
+            }
+        }
+    }
+    delete [] old_ctrl;
+}
+
+/**
+ * @brief FlatHashSet::FlatHashSet Construct an empty set without any slots
+ */
+FlatHashSet::FlatHashSet() : FlatHashMap(false)
+{
+}
+
+/**
+ * @brief FlatHashSet::insert
+ * @param key
+ * @return true if key was added, false if it was already there
+ */
+bool FlatHashSet::insert(int key)
+{
+    return FlatHashMap::insert(key, 0);
+}
@@ -0,0 +1,75 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstdint>
+#include "myvector.h"
+
+// Open addressing hash map from int keys to int values in the style of a
+//   Swiss table. Every slot has one control byte: empty, deleted, or the low
+//   7 bits of the key's hash. Lookups compare 16 control bytes at once (one
+//   SSE2 instruction where available) and only look at a key when its
+//   7 bit tag matches. Keys and values live in flat MyVector buffers as the
+//   Thing::i of each slot.
+//
+//   Slots are probed a group of 16 at a time. An erased slot only becomes a
+//   tombstone when its group is full, since no probe can have passed over a
+//   group that still has an empty slot.
+class FlatHashMap
+{
+public:
+    static const size_t group_size = 16;
+
+    FlatHashMap();
+    ~FlatHashMap();
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    size_t size() const;
+    bool empty() const;
+    size_t capacity() const;
+
+    bool insert(int key, int value);
+    int& operator[](int key);
+    int* find(int key);
+    bool contains(int key);
+    bool erase(int key);
+
+    void reserve(size_t n);
+    void clear();
+
+protected:
+    explicit FlatHashMap(bool store_values);
+
+    static uint64_t hash(int key);
+    size_t find_slot(int key, uint64_t h);
+    size_t insert_slot(int key, uint64_t h);
+    void rehash(size_t new_capacity);
+
+    int8_t* ctrl;        ///< One control byte per slot
+    MyVector keys;       ///< Key of each full slot
+    MyVector values;     ///< Value of each full slot, unused by FlatHashSet
+    size_t n_items;      ///< Full slots
+    size_t n_slots;      ///< Slots in total, a power of two and a multiple of group_size
+    size_t growth_left;  ///< Empty slots that may still be filled before a rehash
+    bool store_values;
+};
+
+// Set of ints with the same layout as FlatHashMap but no value buffer.
+class FlatHashSet : protected FlatHashMap
+{
+public:
+    FlatHashSet();
+
+    using FlatHashMap::size;
+    using FlatHashMap::empty;
+    using FlatHashMap::capacity;
+    using FlatHashMap::contains;
+    using FlatHashMap::erase;
+    using FlatHashMap::reserve;
+    using FlatHashMap::clear;
+
+    bool insert(int key);
+};
+
+#endif // FLATHASHMAP_H
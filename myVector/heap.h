@@ -0,0 +1,404 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdexcept>
+#include "myvector.h"
+
+// Min-heap of things ordered by Thing::i, stored in a MyVector buffer.
+//   D is the number of children per node. D = 4 keeps a node's children
+//   in one cache line and halves the depth of a binary heap, which is
+//   usually faster for pop-heavy workloads; D = 2 gives a binary heap.
+template<unsigned D = 4>
+class DaryHeap : protected MyVector
+{
+    static_assert(D >= 2, "a heap needs at least two children per node");
+public:
+    using MyVector::size;
+    bool empty() const;
+
+    Thing& top();
+    void push(const Thing& t);
+    void pop();
+
+    Thing push_pop(const Thing& t);
+    Thing replace_top(const Thing& t);
+
+    void heapify(const Thing* first, size_t n);
+
+protected:
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+};
+
+typedef DaryHeap<2> BinaryHeap;
+
+// Min-heap that hands out a handle for every pushed priority so that the
+//   priority can later be lowered with decrease_key(). The position of
+//   every handle inside the heap is kept up to date on every move.
+//   All three arrays are MyVectors of things used as int arrays.
+template<unsigned D = 4>
+class IndexedDaryHeap
+{
+    static_assert(D >= 2, "a heap needs at least two children per node");
+public:
+    size_t size() const;
+    bool empty() const;
+
+    int push(int priority);
+    int top();
+    int top_priority();
+    int pop();
+
+    bool contains(int handle);
+    int priority(int handle);
+    void decrease_key(int handle, int priority);
+
+protected:
+    void place(size_t pos, int priority, int handle);
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+
+    MyVector priorities;  ///< Heap ordered priorities
+    MyVector handles;     ///< Handle of the priority at the same heap position
+    MyVector positions;   ///< Heap position of each handle, -1 once popped
+};
+
+/**
+ * @brief DaryHeap::empty
+ * @return true if there are no things in the heap
+ */
+template<unsigned D>
+bool DaryHeap<D>::empty() const
+{
+    return n_items == 0;
+}
+
+/**
+ * @brief DaryHeap::top
+ * @return A reference to the smallest thing. Never called on an empty heap.
+ * Changing its value breaks the heap, use replace_top() instead.
+ */
+template<unsigned D>
+Thing &DaryHeap<D>::top()
+{
+    return data[0];
+}
+
+/**
+ * @brief DaryHeap::push
+ * @param t The thing to add
+ */
+template<unsigned D>
+void DaryHeap<D>::push(const Thing &t)
+{
+    MyVector::push_back(t);
+    sift_up(n_items - 1);
+}
+
+/**
+ * @brief DaryHeap::pop
+ * Remove the smallest thing. Never called on an empty heap.
+ */
+template<unsigned D>
+void DaryHeap<D>::pop()
+{
+    data[0] = data[n_items - 1];
+    MyVector::pop_back();
+    if (n_items > 1){
+        sift_down(0);
+    }
+}
+
+/**
+ * @brief DaryHeap::push_pop
+ * @param t The thing to add
+ * @return The smallest thing out of t and the heap, which is removed.
+ * Same as push() then pop() but with at most one sift down, and none
+ * when t is already the smallest.
+ */
+template<unsigned D>
+Thing DaryHeap<D>::push_pop(const Thing &t)
+{
+    if (n_items == 0 || t.i <= data[0].i){
+        return t;
+    }
+    Thing smallest = data[0];
+    data[0] = t;
+    sift_down(0);
+    return smallest;
+}
+
+/**
+ * @brief DaryHeap::replace_top
+ * @param t The thing to add
+ * @return The old smallest thing.
+ * Same as pop() then push() with a single sift down. Never called on an empty heap.
+ */
+template<unsigned D>
+Thing DaryHeap<D>::replace_top(const Thing &t)
+{
+    Thing smallest = data[0];
+    data[0] = t;
+    sift_down(0);
+    return smallest;
+}
+
+/**
+ * @brief DaryHeap::heapify
+ * @param first The things to build the heap from
+ * @param n Number of things
+ * Replace the contents of the heap with a copy of the n things.
+ * Sifts down every parent from the last one to the root, which is O(n)
+ * instead of the O(n log n) of n pushes.
+ */
+template<unsigned D>
+void DaryHeap<D>::heapify(const Thing *first, size_t n)
+{
+    n_items = 0;
+    if (n > n_allocated){
+        reallocate(n);
+    }
+    for (size_t i = 0; i < n; ++i){
+        data[i] = first[i];
+    }
+    n_items = n;
+    if (n < 2){
+        return;
+    }
+    for (size_t i = (n - 2) / D + 1; i-- > 0;){
+        sift_down(i);
+    }
+}
+
+/**
+ * Move the thing at position i up until its parent is not larger.
+ * Shifts parents down into the hole instead of swapping.
+ */
+template<unsigned D>
+void DaryHeap<D>::sift_up(size_t i)
+{
+    Thing moving = data[i];
+    while (i > 0){
+        size_t parent = (i - 1) / D;
+        if (data[parent].i <= moving.i){
+            break;
+        }
+        data[i] = data[parent];
+        i = parent;
+    }
+    data[i] = moving;
+}
+
+/**
+ * Move the thing at position i down until none of its children are smaller.
+ * Shifts the smallest child up into the hole instead of swapping.
+ */
+template<unsigned D>
+void DaryHeap<D>::sift_down(size_t i)
+{
+    Thing moving = data[i];
+    for (;;){
+        size_t first_child = i * D + 1;
+        if (first_child >= n_items){
+            break;
+        }
+        size_t last_child = first_child + D < n_items ? first_child + D : n_items;
+        size_t smallest = first_child;
+        for (size_t c = first_child + 1; c < last_child; ++c){
+            if (data[c].i < data[smallest].i){
+                smallest = c;
+            }
+        }
+        if (moving.i <= data[smallest].i){
+            break;
+        }
+        data[i] = data[smallest];
+        i = smallest;
+    }
+    data[i] = moving;
+}
+
+/**
+ * @brief IndexedDaryHeap::size
+ * @return The number of priorities still in the heap
+ */
+template<unsigned D>
+size_t IndexedDaryHeap<D>::size() const
+{
+    return priorities.size();
+}
+
+/**
+ * @brief IndexedDaryHeap::empty
+ * @return true if every pushed priority has been popped
+ */
+template<unsigned D>
+bool IndexedDaryHeap<D>::empty() const
+{
+    return priorities.size() == 0;
+}
+
+/**
+ * @brief IndexedDaryHeap::push
+ * @param priority
+ * @return The handle for this priority. Handles count up from 0 and are never reused.
+ */
+template<unsigned D>
+int IndexedDaryHeap<D>::push(int priority)
+{
+    int handle = int(positions.size());
+    positions.push_back(Thing(int(priorities.size())));
+    priorities.push_back(Thing(priority));
+    handles.push_back(Thing(handle));
+    sift_up(priorities.size() - 1);
+    return handle;
+}
+
+/**
+ * @brief IndexedDaryHeap::top
+ * @return The handle with the smallest priority. Never called on an empty heap.
+ */
+template<unsigned D>
+int IndexedDaryHeap<D>::top()
+{
+    return handles[0].i;
+}
+
+/**
+ * @brief IndexedDaryHeap::top_priority
+ * @return The smallest priority. Never called on an empty heap.
+ */
+template<unsigned D>
+int IndexedDaryHeap<D>::top_priority()
+{
+    return priorities[0].i;
+}
+
+/**
+ * @brief IndexedDaryHeap::pop
+ * @return The handle with the smallest priority, which is removed.
+ * Never called on an empty heap.
+ */
+template<unsigned D>
+int IndexedDaryHeap<D>::pop()
+{
+    int handle = handles[0].i;
+    size_t last = priorities.size() - 1;
+    place(0, priorities[last].i, handles[last].i);
+    priorities.pop_back();
+    handles.pop_back();
+    positions[handle].i = -1;
+    if (priorities.size() > 1){
+        sift_down(0);
+    }
+    return handle;
+}
+
+/**
+ * @brief IndexedDaryHeap::contains
+ * @param handle
+ * @return true if handle was pushed and has not been popped yet
+ */
+template<unsigned D>
+bool IndexedDaryHeap<D>::contains(int handle)
+{
+    return handle >= 0 && size_t(handle) < positions.size() && positions[handle].i >= 0;
+}
+
+/**
+ * @brief IndexedDaryHeap::priority
+ * @param handle
+ * @return The current priority of handle
+ * @throws std::out_of_range if the handle is not in the heap
+ */
+template<unsigned D>
+int IndexedDaryHeap<D>::priority(int handle)
+{
+    if (!contains(handle)){
+        throw std::out_of_range("handle is not in the heap");
+    }
+    return priorities[positions[handle].i].i;
+}
+
+/**
+ * @brief IndexedDaryHeap::decrease_key
+ * @param handle
+ * @param priority New priority, must not be larger than the current one
+ * @throws std::out_of_range if the handle is not in the heap
+ * @throws std::invalid_argument if the priority would increase
+ */
+template<unsigned D>
+void IndexedDaryHeap<D>::decrease_key(int handle, int priority)
+{
+    if (!contains(handle)){
+        throw std::out_of_range("handle is not in the heap");
+    }
+    size_t pos = positions[handle].i;
+    if (priority > priorities[pos].i){
+        throw std::invalid_argument("decrease_key cannot increase a priority");
+    }
+    priorities[pos].i = priority;
+    sift_up(pos);
+}
+
+/**
+ * Store priority/handle at heap position pos and record the new position.
+ */
+template<unsigned D>
+void IndexedDaryHeap<D>::place(size_t pos, int priority, int handle)
+{
+    priorities[pos].i = priority;
+    handles[pos].i = handle;
+    positions[handle].i = int(pos);
+}
+
+/**
+ * Move the entry at position i up until its parent is not larger.
+ */
+template<unsigned D>
+void IndexedDaryHeap<D>::sift_up(size_t i)
+{
+    int priority = priorities[i].i;
+    int handle = handles[i].i;
+    while (i > 0){
+        size_t parent = (i - 1) / D;
+        if (priorities[parent].i <= priority){
+            break;
+        }
+        place(i, priorities[parent].i, handles[parent].i);
+        i = parent;
+    }
+    place(i, priority, handle);
+}
+
+/**
+ * Move the entry at position i down until none of its children are smaller.
+ */
+template<unsigned D>
+void IndexedDaryHeap<D>::sift_down(size_t i)
+{
+    size_t n = priorities.size();
+    int priority = priorities[i].i;
+    int handle = handles[i].i;
+    for (;;){
+        size_t first_child = i * D + 1;
+        if (first_child >= n){
+            break;
+        }
+        size_t last_child = first_child + D < n ? first_child + D : n;
+        size_t smallest = first_child;
+        for (size_t c = first_child + 1; c < last_child; ++c){
+            if (priorities[c].i < priorities[smallest].i){
+                smallest = c;
+            }
+        }
+        if (priority <= priorities[smallest].i){
+            break;
+        }
+        place(i, priorities[smallest].i, handles[smallest].i);
+        i = smallest;
+    }
+    place(i, priority, handle);
+}
+
+#endif // HEAP_H
@@ -1,4 +1,17 @@
 #include "myvector.h"
+
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
 bool Thing::verbose = false;
 size_t Thing::last_alloc = 0;
 
@@ -13,16 +26,39 @@ MyVector::MyVector()
     data = nullptr;
     n_items = 0;
     n_allocated = 0;
+    align = 0;
+    huge_pages = false;
 
 }
 
+/**
+ * @brief MyVector::MyVector Construct a vector with size 0 whose buffers are aligned
+ * @param alignment Byte alignment of every buffer, a power of two such as
+ *  cache_line_size or huge_page_size.
+ * @param huge_pages If true, buffers of at least huge_page_size bytes are
+ *  advised to the kernel as huge page candidates to cut TLB misses.
+ *  Smaller alignments are raised to what the system allocator accepts,
+ *  at least alignof(Thing) and sizeof(void*).
+ * @throws std::invalid_argument if alignment is not a power of two
+ */
+MyVector::MyVector(size_t alignment, bool huge_pages)
+    : data(nullptr), n_items(0), n_allocated(0), align(alignment), huge_pages(huge_pages)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0){
+        throw std::invalid_argument("alignment must be a power of two");
+    }
+    size_t min_align = alignof(Thing) > sizeof(void*) ? alignof(Thing) : sizeof(void*);
+    if (align < min_align){
+        align = min_align;
+    }
+}
+
 /**
  * @brief MyVector::~MyVector Free any memory that you have allocated do this last
  */
 MyVector::~MyVector()
 {
-    // Do this last - if you have an error in your destructor it can crash your program
-    //delete [] data;
+    release(data, n_allocated);
 }
 
 /**
@@ -51,25 +87,15 @@ size_t MyVector::allocated_length() const
  */
 void MyVector::push_back(const Thing &t)
 {
-    ++n_items;
     if (n_allocated == 0){
-        Thing *temp = new Thing[1];
-        data = temp;
-        ++n_allocated;
+        reallocate(1);
     }
-    if (n_items > n_allocated){
-        n_allocated = n_allocated * 2; //double the amount of memory
-
-        Thing *temp = new Thing[n_allocated]; //create our temporary new memory on the heap
-
-        for (size_t i=0;i<n_items;i++){
-            temp[i] = data[i]; //move all the data across
-        }
-        delete [] data; //prevent memory leak
-        data = temp; //make it permanent
+    else if (n_items == n_allocated){
+        reallocate(n_allocated * 2); //double the amount of memory
     }
 
-    data[n_items - 1] = t;
+    data[n_items] = t;
+    ++n_items;
 }
 /**
  * @brief MyVector::pop_back
@@ -81,16 +107,8 @@ void MyVector::pop_back()
     --n_items;
     float check = float(n_items)/float(n_allocated);
     if (check < 0.25){
-        Thing * temp = new Thing[allocated_length()/2];
-        for (size_t i = 0;i<size();++i){
-            temp[i] = *(data + i);
-        }
-        delete [] data;
-        n_allocated /= 2;
-        data = temp;
+        reallocate(allocated_length()/2);
     }
-
-
 }
 
 /**
@@ -159,18 +177,187 @@ Thing &MyVector::at(size_t i)
 }
 
 /**
- * Reallocate the memory buffer to be "new_size" length, using new Thing[new_size]
+ * @brief MyVector::reserve
+ * @param new_size
+ * @param n_threads Threads used to initialise the new buffer, see allocate()
+ * Make sure there is room for at least new_size things without reallocating.
+ */
+void MyVector::reserve(size_t new_size, unsigned n_threads)
+{
+    if (new_size > n_allocated){
+        reallocate(new_size, n_threads);
+    }
+}
+
+/**
+ * @brief MyVector::alignment
+ * @return The byte alignment of the buffer, 0 if it comes from plain new Thing[]
+ */
+size_t MyVector::alignment() const
+{
+    return align;
+}
+
+/**
+ * @brief MyVector::swap
+ * @param other
+ * Exchange buffers, counters and allocation settings with other without copying any things.
+ */
+void MyVector::swap(MyVector &other)
+{
+    std::swap(data, other.data);
+    std::swap(n_items, other.n_items);
+    std::swap(n_allocated, other.n_allocated);
+    std::swap(align, other.align);
+    std::swap(huge_pages, other.huge_pages);
+}
+
+/**
+ * Reallocate the memory buffer to be "new_size" length, using allocate()
  * Copy all items from the old buffer into the new one.
- * Delete the old buffer using delete[]
+ * Delete the old buffer using release()
  */
-void MyVector::reallocate(size_t new_size)
+void MyVector::reallocate(size_t new_size, unsigned n_threads)
 {
-    Thing * temp = new Thing[new_size];
+    new_size = capacity_for(new_size);
+    Thing * temp = allocate(new_size, n_threads);
     for (size_t i = 0;i<n_items;i++){
         temp[i] = data[i];
     }
-    delete [] data;
+    release(data, n_allocated);
     data = temp;
     n_allocated = new_size;
 }
 
+/**
+ * Round a capacity of n things up to whole huge pages once the buffer is at
+ * least one huge page, so that its tail can be huge page backed too.
+ * Smaller buffers, and vectors without huge_pages, keep exactly n.
+ */
+size_t MyVector::capacity_for(size_t n) const
+{
+    const size_t huge_page_things = huge_page_size / sizeof(Thing);
+    if (!huge_pages || n < huge_page_things){
+        return n;
+    }
+    return (n + huge_page_things - 1) / huge_page_things * huge_page_things;
+}
+
+/**
+ * @brief MyVector::allocate
+ * @param n Number of things
+ * @param n_threads Threads that construct the things
+ * @return A buffer of n default constructed things
+ *
+ * Unaligned vectors use new Thing[n]. Aligned vectors take raw aligned
+ * memory and construct the things in place, split into page sized chunks
+ * over n_threads threads. The thread that first writes a page decides which
+ * NUMA node it lives on, so a buffer that will be processed in parallel
+ * should be initialised by the same number of threads.
+ */
+Thing *MyVector::allocate(size_t n, unsigned n_threads)
+{
+    if (align == 0){
+        return new Thing[n];
+    }
+
+    // Only the start has to be aligned, so the size is not rounded up:
+    //   a huge page aligned vector of one thing takes one thing's worth.
+    size_t bytes = n == 0 ? sizeof(Thing) : n * sizeof(Thing);
+#ifdef _WIN32
+    void* raw = _aligned_malloc(bytes, align);
+    if (raw == nullptr){
+        throw std::bad_alloc();
+    }
+#else
+    void* raw = nullptr;
+    if (posix_memalign(&raw, align, bytes) != 0){
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge_pages && bytes >= huge_page_size){
+        madvise(raw, bytes, MADV_HUGEPAGE);
+    }
+#endif
+#endif
+
+    Thing* buffer = static_cast<Thing*>(raw);
+    const size_t page_things = 4096 / sizeof(Thing);
+    size_t pages = (n + page_things - 1) / page_things;
+    if (n_threads > pages){
+        n_threads = unsigned(pages);
+    }
+    if (n_threads <= 1){
+        for (size_t i = 0; i < n; ++i){
+            new (buffer + i) Thing();
+        }
+        return buffer;
+    }
+
+    // If a thread cannot be started, the ones already running are joined,
+    //   their things destroyed and the buffer freed before rethrowing.
+    std::thread* workers = nullptr;
+    unsigned started = 0;
+    size_t pages_per_thread = (pages + n_threads - 1) / n_threads;
+    try{
+        workers = new std::thread[n_threads - 1];
+        for (unsigned t = 0; t < n_threads; ++t){
+            size_t first = t * pages_per_thread * page_things;
+            size_t last = (t + 1) * pages_per_thread * page_things;
+            if (last > n){
+                last = n;
+            }
+            auto touch = [buffer, first, last]{
+                for (size_t i = first; i < last; ++i){
+                    new (buffer + i) Thing();
+                }
+            };
+            if (t + 1 < n_threads){
+                workers[t] = std::thread(touch);
+                ++started;
+            }
+            else{
+                touch();
+            }
+        }
+    }
+    catch (...){
+        for (unsigned t = 0; t < started; ++t){
+            workers[t].join();
+        }
+        delete [] workers;
+        size_t constructed = started * pages_per_thread * page_things;
+        release(buffer, constructed < n ? constructed : n);
+        throw;
+    }
+    for (unsigned t = 0; t + 1 < n_threads; ++t){
+        workers[t].join();
+    }
+    delete [] workers;
+    return buffer;
+}
+
+/**
+ * @brief MyVector::release
+ * @param buffer A buffer from allocate(), may be nullptr
+ * @param n The number of things constructed in it, which is all of them
+ * unless allocate() is cleaning up after a failure
+ */
+void MyVector::release(Thing *buffer, size_t n)
+{
+    if (buffer == nullptr){
+        return;
+    }
+    if (align == 0){
+        delete [] buffer;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i){
+        buffer[i].~Thing();
+    }
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    free(buffer);
+#endif
+}
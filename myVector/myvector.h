@@ -2,6 +2,7 @@
 #define MYVECTOR_H
 #define _GLIBCXX_VECTOR 1
 
+#include <cstdlib>
 #include <iostream>
 
 class Thing{
@@ -34,14 +35,30 @@ public:
         return malloc(sz);
     }
 
+    /**
+     * @brief operator delete[]
+     * @param ptr
+     * Pairs with operator new[] above, which gets its memory from malloc.
+     */
+    void operator delete[](void* ptr){
+        free(ptr);
+    }
+
 };
 
 class MyVector
 {
 public:
+    static const size_t cache_line_size = 64;
+    static const size_t huge_page_size = 2 * 1024 * 1024;
+
     MyVector();
+    explicit MyVector(size_t alignment, bool huge_pages = false);
     ~MyVector();
 
+    MyVector(const MyVector&) = delete;
+    MyVector& operator=(const MyVector&) = delete;
+
     size_t size() const;
     size_t allocated_length() const;
 
@@ -57,11 +74,20 @@ public:
     Thing& operator[](size_t i);
     Thing& at(size_t i);
 
+    void reserve(size_t new_size, unsigned n_threads = 1);
+    size_t alignment() const;
+    void swap(MyVector& other);
+
 protected:
-    void reallocate(size_t new_size);
+    void reallocate(size_t new_size, unsigned n_threads = 1);
+    size_t capacity_for(size_t n) const;
+    Thing* allocate(size_t n, unsigned n_threads);
+    void release(Thing* buffer, size_t n);
 
     Thing* data;
     size_t n_items, n_allocated;
+    size_t align;     ///< Buffer alignment in bytes, 0 for plain new Thing[]
+    bool huge_pages;  ///< Ask the kernel to back large buffers with huge pages
 };
 
 #endif // MYVECTOR_H
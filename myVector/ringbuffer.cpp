@@ -0,0 +1,206 @@
+#include "ringbuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief next_power_of_two
+ * @return The smallest power of two that is >= n (1 for n == 0)
+ */
+static size_t next_power_of_two(size_t n)
+{
+    size_t p = 1;
+    while (p < n){
+        p <<= 1;
+    }
+    return p;
+}
+
+/**
+ * @brief RingBuffer::RingBuffer Construct an empty ring buffer with no storage
+ */
+RingBuffer::RingBuffer() : head(0)
+{
+}
+
+/**
+ * @brief RingBuffer::RingBuffer Construct an empty ring buffer
+ * @param capacity Number of things to make room for up front.
+ * Rounded up to the next power of two.
+ */
+RingBuffer::RingBuffer(size_t capacity) : head(0)
+{
+    reserve(capacity);
+}
+
+/**
+ * @brief RingBuffer::capacity
+ * @return The number of things that fit before the buffer has to grow
+ */
+size_t RingBuffer::capacity() const
+{
+    return n_allocated;
+}
+
+/**
+ * @brief RingBuffer::empty
+ * @return true if there are no things in the buffer
+ */
+bool RingBuffer::empty() const
+{
+    return n_items == 0;
+}
+
+/**
+ * @brief RingBuffer::push_back
+ * @param t The thing to add
+ * Add a thing after the current back, doubling the buffer if it is full.
+ */
+void RingBuffer::push_back(const Thing &t)
+{
+    if (n_items == n_allocated){
+        grow(n_allocated == 0 ? 1 : n_allocated * 2);
+    }
+    data[(head + n_items) & (n_allocated - 1)] = t;
+    ++n_items;
+}
+
+/**
+ * @brief RingBuffer::push_front
+ * @param t The thing to add
+ * Add a thing before the current front, doubling the buffer if it is full.
+ */
+void RingBuffer::push_front(const Thing &t)
+{
+    if (n_items == n_allocated){
+        grow(n_allocated == 0 ? 1 : n_allocated * 2);
+    }
+    head = (head - 1) & (n_allocated - 1);
+    data[head] = t;
+    ++n_items;
+}
+
+/**
+ * @brief RingBuffer::pop_back
+ * Remove the back thing. Never called on an empty buffer.
+ * The buffer is not shrunk so that a queue that drains and refills does not reallocate.
+ */
+void RingBuffer::pop_back()
+{
+    --n_items;
+}
+
+/**
+ * @brief RingBuffer::pop_front
+ * Remove the front thing. Never called on an empty buffer.
+ */
+void RingBuffer::pop_front()
+{
+    head = (head + 1) & (n_allocated - 1);
+    --n_items;
+}
+
+/**
+ * @brief RingBuffer::front
+ * @return A reference to the front thing. Never called on an empty buffer.
+ */
+Thing &RingBuffer::front()
+{
+    return data[head];
+}
+
+/**
+ * @brief RingBuffer::back
+ * @return A reference to the back thing. Never called on an empty buffer.
+ */
+Thing &RingBuffer::back()
+{
+    return data[(head + n_items - 1) & (n_allocated - 1)];
+}
+
+/**
+ * @brief RingBuffer::operator []
+ * @param i
+ * @return A reference to the ith thing counting from the front
+ */
+Thing &RingBuffer::operator[](size_t i)
+{
+    return data[(head + i) & (n_allocated - 1)];
+}
+
+/**
+ * @brief RingBuffer::at
+ * @param i
+ * @return A reference to the ith thing counting from the front after
+ * checking that the index is not out of bounds.
+ */
+Thing &RingBuffer::at(size_t i)
+{
+    if (i >= n_items){
+        throw std::out_of_range("Requested index out of bounds.");
+    }
+    return (*this)[i];
+}
+
+/**
+ * @brief RingBuffer::first_segment
+ * @return The things from the front up to the end of the buffer or the back,
+ * whichever comes first.
+ */
+ThingSpan RingBuffer::first_segment()
+{
+    ThingSpan span;
+    span.ptr = data + head;
+    span.length = std::min(n_items, n_allocated - head);
+    return span;
+}
+
+/**
+ * @brief RingBuffer::second_segment
+ * @return The things that wrapped around to the start of the buffer.
+ * Empty when the contents do not wrap.
+ * Together with first_segment() this covers every thing in order.
+ */
+ThingSpan RingBuffer::second_segment()
+{
+    ThingSpan span;
+    span.ptr = data;
+    span.length = n_items - first_segment().length;
+    return span;
+}
+
+/**
+ * @brief RingBuffer::reserve
+ * @param capacity
+ * Make sure there is room for at least capacity things without growing.
+ */
+void RingBuffer::reserve(size_t capacity)
+{
+    if (capacity > n_allocated){
+        grow(next_power_of_two(capacity));
+    }
+}
+
+/**
+ * @brief RingBuffer::clear
+ * Remove every thing but keep the buffer.
+ */
+void RingBuffer::clear()
+{
+    n_items = 0;
+    head = 0;
+}
+
+/**
+ * Rotate the contents so that the front is at data[0], then let
+ * MyVector::reallocate move them into a buffer of "new_capacity" things.
+ * new_capacity must be a power of two.
+ */
+void RingBuffer::grow(size_t new_capacity)
+{
+    if (head != 0){
+        std::rotate(data, data + head, data + n_allocated);
+        head = 0;
+    }
+    reallocate(new_capacity);
+}
@@ -0,0 +1,48 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include "myvector.h"
+
+// A contiguous run of things inside a ring buffer.
+struct ThingSpan{
+    Thing* ptr;     ///< First thing in the run
+    size_t length;  ///< Number of things in the run
+};
+
+// Growable circular queue that keeps its things in a MyVector buffer.
+//   The buffer length is always a power of two so that wrapping an index
+//   is a single mask instead of a modulo.
+class RingBuffer : protected MyVector
+{
+public:
+    RingBuffer();
+    explicit RingBuffer(size_t capacity);
+
+    using MyVector::size;
+    size_t capacity() const;
+    bool empty() const;
+
+    void push_back(const Thing& t);
+    void push_front(const Thing& t);
+    void pop_back();
+    void pop_front();
+
+    Thing& front();
+    Thing& back();
+
+    Thing& operator[](size_t i);
+    Thing& at(size_t i);
+
+    ThingSpan first_segment();
+    ThingSpan second_segment();
+
+    void reserve(size_t capacity);
+    void clear();
+
+protected:
+    void grow(size_t new_capacity);
+
+    size_t head;  ///< Index in data of the front thing
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,119 @@
+#include "spscqueue.h"
+
+#include <algorithm>
+
+/**
+ * @brief SpscQueue::SpscQueue Construct an empty queue
+ * @param capacity Maximum number of things held at once.
+ * Rounded up to the next power of two so indices wrap with a mask.
+ */
+SpscQueue::SpscQueue(size_t capacity)
+    : head(0), cached_tail(0), tail(0), cached_head(0)
+{
+    size_t n = 1;
+    while (n < capacity){
+        n <<= 1;
+    }
+    buffer = new Thing[n];
+    mask = n - 1;
+}
+
+/**
+ * @brief SpscQueue::~SpscQueue Free the buffer. Both threads must be done with the queue.
+ */
+SpscQueue::~SpscQueue()
+{
+    delete [] buffer;
+}
+
+/**
+ * @brief SpscQueue::capacity
+ * @return The maximum number of things the queue can hold
+ */
+size_t SpscQueue::capacity() const
+{
+    return mask + 1;
+}
+
+/**
+ * @brief SpscQueue::size_approx
+ * @return The number of things in the queue, between 0 and capacity().
+ * Only exact when neither side is running.
+ */
+size_t SpscQueue::size_approx() const
+{
+    // head first: it never passes the tail read after it, so t - h cannot wrap
+    size_t h = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+    return std::min(t - h, capacity());
+}
+
+/**
+ * @brief SpscQueue::try_push
+ * @param t The thing to add
+ * @return false if the queue is full. Producer thread only.
+ */
+bool SpscQueue::try_push(const Thing &t)
+{
+    return try_push_n(&t, 1) == 1;
+}
+
+/**
+ * @brief SpscQueue::try_push_n
+ * @param items Things to add, in order
+ * @param n Number of things in items
+ * @return How many of the first things were added, which is less than n
+ * when the queue fills up. The consumer sees the whole batch at once.
+ * Producer thread only.
+ */
+size_t SpscQueue::try_push_n(const Thing *items, size_t n)
+{
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t space = capacity() - (t - cached_head);
+    if (space < n){
+        cached_head = head.load(std::memory_order_acquire);
+        space = capacity() - (t - cached_head);
+    }
+    n = std::min(n, space);
+    for (size_t i = 0; i < n; ++i){
+        buffer[(t + i) & mask] = items[i];
+    }
+    if (n != 0){
+        tail.store(t + n, std::memory_order_release);
+    }
+    return n;
+}
+
+/**
+ * @brief SpscQueue::try_pop
+ * @param out Set to the front thing
+ * @return false if the queue is empty. Consumer thread only.
+ */
+bool SpscQueue::try_pop(Thing &out)
+{
+    return try_pop_n(&out, 1) == 1;
+}
+
+/**
+ * @brief SpscQueue::try_pop_n
+ * @param out Receives up to n things from the front, in order
+ * @param n Room in out
+ * @return How many things were removed. Consumer thread only.
+ */
+size_t SpscQueue::try_pop_n(Thing *out, size_t n)
+{
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t available = cached_tail - h;
+    if (available < n){
+        cached_tail = tail.load(std::memory_order_acquire);
+        available = cached_tail - h;
+    }
+    n = std::min(n, available);
+    for (size_t i = 0; i < n; ++i){
+        out[i] = buffer[(h + i) & mask];
+    }
+    if (n != 0){
+        head.store(h + n, std::memory_order_release);
+    }
+    return n;
+}
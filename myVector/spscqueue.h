@@ -0,0 +1,54 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include "myvector.h"
+
+// Bounded lock-free queue for handing things from exactly one producer
+//   thread to exactly one consumer thread.
+//
+//   head is only written by the consumer and tail only by the producer.
+//   Each side keeps a private copy of the other side's index and only
+//   reloads it when the copy says the queue looks full (producer) or
+//   empty (consumer), so in steady state neither side touches the other's
+//   cache line. Every group of fields is padded to its own cache line.
+//
+//   Allocate with automatic or static storage: C++11 operator new does
+//   not honour the over-alignment.
+class alignas(64) SpscQueue
+{
+public:
+    static constexpr size_t cache_line = 64;
+
+    explicit SpscQueue(size_t capacity);
+    ~SpscQueue();
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const;
+    size_t size_approx() const;
+
+    // Producer side
+    bool try_push(const Thing& t);
+    size_t try_push_n(const Thing* items, size_t n);
+
+    // Consumer side
+    bool try_pop(Thing& out);
+    size_t try_pop_n(Thing* out, size_t n);
+
+private:
+    // Read-only after construction, shared by both sides.
+    alignas(cache_line) Thing* buffer;
+    size_t mask;
+
+    // Consumer owned.
+    alignas(cache_line) std::atomic<size_t> head;
+    size_t cached_tail;
+
+    // Producer owned.
+    alignas(cache_line) std::atomic<size_t> tail;
+    size_t cached_head;
+};
+
+#endif // SPSCQUEUE_H
@@ -1,9 +1,17 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include <cstring>
+#include <cstdint>
 
 #define _GLIBCXX_VECTOR 1
 #include "myvector.h"
+#include "ringbuffer.h"
+#include "spscqueue.h"
+#include "heap.h"
+#include "flathashmap.h"
+
+#include <atomic>
+#include <thread>
 
 //#ifdef _WIN32
 //int main(int argc, char* argv[])
@@ -188,3 +196,273 @@ TEST_CASE_METHOD(MyVector, "begin(), end(), front(), back()"){
         REQUIRE((end()-1)->i == i);
     }
 }
+
+TEST_CASE("Aligned buffers"){
+    SECTION("Cache line aligned growth keeps alignment and contents"){
+        MyVector v(MyVector::cache_line_size);
+        REQUIRE(v.alignment() == 64);
+        for(int i = 0; i < 100; ++i){
+            v.push_back(Thing(i));
+            REQUIRE(reinterpret_cast<std::uintptr_t>(v.begin()) % 64 == 0);
+        }
+        for(int i = 0; i < 100; ++i){
+            REQUIRE(v[i].i == i);
+        }
+    }
+    SECTION("Parallel first touch initialises every thing"){
+        MyVector v(MyVector::huge_page_size, true);
+        v.push_back(Thing(42));
+        REQUIRE(v.allocated_length() == 1);
+        v.reserve(600000, 4);
+        REQUIRE(v.allocated_length() >= 600000);
+        REQUIRE(v.allocated_length() * sizeof(Thing) % MyVector::huge_page_size == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(v.begin()) % MyVector::huge_page_size == 0);
+        REQUIRE(v.front().i == 42);
+        REQUIRE(v.begin()[599999].i == -1);
+    }
+    SECTION("Alignment must be a power of two"){
+        REQUIRE_THROWS(MyVector(48));
+    }
+    SECTION("Alignments below a pointer's are raised to one"){
+        size_t sizes[] = {1, 2, 4};
+        for(size_t a : sizes){
+            MyVector v(a);
+            REQUIRE(v.alignment() >= sizeof(void*));
+            for(int i = 0; i < 10; ++i){
+                v.push_back(Thing(i));
+            }
+            REQUIRE(v.back().i == 9);
+        }
+    }
+    SECTION("Small huge page aligned buffers are not padded"){
+        MyVector v(MyVector::huge_page_size, true);
+        for(int i = 0; i < 3; ++i){
+            v.push_back(Thing(i));
+        }
+        REQUIRE(v.allocated_length() == 4);
+    }
+}
+
+TEST_CASE("Ring buffer push/pop at both ends"){
+    RingBuffer rb;
+    REQUIRE(rb.empty());
+    for(int i = 0; i < 10; ++i){
+        rb.push_back(Thing(i));
+    }
+    for(int i = 1; i <= 5; ++i){
+        rb.push_front(Thing(-i));
+    }
+    REQUIRE(rb.size() == 15);
+    REQUIRE(rb.capacity() == 16);
+    REQUIRE(rb.front().i == -5);
+    REQUIRE(rb.back().i == 9);
+    for(int i = 0; i < 15; ++i){
+        REQUIRE(rb[i].i == i - 5);
+    }
+    REQUIRE_THROWS(rb.at(15));
+
+    rb.pop_front();
+    rb.pop_back();
+    REQUIRE(rb.front().i == -4);
+    REQUIRE(rb.back().i == 8);
+    REQUIRE(rb.size() == 13);
+}
+
+TEST_CASE("Ring buffer wraps and grows in order"){
+    RingBuffer rb(4);
+    REQUIRE(rb.capacity() == 4);
+    for(int i = 0; i < 4; ++i){
+        rb.push_back(Thing(i));
+    }
+    rb.pop_front();
+    rb.pop_front();
+    rb.push_back(Thing(4));
+    rb.push_back(Thing(5));
+
+    SECTION("Segments cover the contents in order"){
+        ThingSpan a = rb.first_segment();
+        ThingSpan b = rb.second_segment();
+        REQUIRE(a.length == 2);
+        REQUIRE(b.length == 2);
+        REQUIRE(a.ptr[0].i == 2);
+        REQUIRE(a.ptr[1].i == 3);
+        REQUIRE(b.ptr[0].i == 4);
+        REQUIRE(b.ptr[1].i == 5);
+    }
+    SECTION("Growing a wrapped buffer keeps the order"){
+        rb.push_back(Thing(6));
+        REQUIRE(rb.capacity() == 8);
+        REQUIRE(rb.second_segment().length == 0);
+        for(int i = 0; i < 5; ++i){
+            REQUIRE(rb[i].i == i + 2);
+        }
+    }
+}
+
+TEST_CASE("SPSC queue batches respect capacity"){
+    SpscQueue q(5);
+    REQUIRE(q.capacity() == 8);
+
+    Thing in[10];
+    for(int i = 0; i < 10; ++i){
+        in[i] = Thing(i);
+    }
+    REQUIRE(q.try_push_n(in, 10) == 8);
+    REQUIRE_FALSE(q.try_push(Thing(42)));
+    REQUIRE(q.size_approx() == 8);
+
+    Thing out[10];
+    REQUIRE(q.try_pop_n(out, 3) == 3);
+    REQUIRE(q.try_push_n(in + 8, 2) == 2);
+    REQUIRE(q.try_pop_n(out + 3, 10) == 7);
+    for(int i = 0; i < 10; ++i){
+        REQUIRE(out[i].i == i);
+    }
+    Thing t;
+    REQUIRE_FALSE(q.try_pop(t));
+}
+
+TEST_CASE("SPSC queue hands things between threads in order"){
+    SpscQueue q(64);
+    const int n = 100000;
+    bool in_order = true;
+
+    std::thread consumer([&]{
+        Thing t;
+        for(int i = 0; i < n; ++i){
+            while(!q.try_pop(t)){}
+            if(t.i != i) in_order = false;
+        }
+    });
+    std::atomic<bool> done(false);
+    bool size_in_range = true;
+    std::thread observer([&]{
+        while(!done.load()){
+            if(q.size_approx() > q.capacity()){
+                size_in_range = false;
+            }
+        }
+    });
+    for(int i = 0; i < n; ++i){
+        while(!q.try_push(Thing(i))){}
+    }
+    consumer.join();
+    done.store(true);
+    observer.join();
+    REQUIRE(in_order);
+    REQUIRE(size_in_range);
+}
+
+TEST_CASE("D-ary heap pops in priority order"){
+    int values[] = {5, 3, 9, 1, 7, 2, 8, 6, 4, 0};
+    SECTION("Binary heap"){
+        BinaryHeap h;
+        for(int v : values) h.push(Thing(v));
+        for(int i = 0; i < 10; ++i){
+            REQUIRE(h.top().i == i);
+            h.pop();
+        }
+        REQUIRE(h.empty());
+    }
+    SECTION("4-ary heap built with heapify"){
+        Thing things[10];
+        for(int i = 0; i < 10; ++i) things[i] = Thing(values[i]);
+        DaryHeap<> h;
+        h.heapify(things, 10);
+        REQUIRE(h.size() == 10);
+        for(int i = 0; i < 10; ++i){
+            REQUIRE(h.top().i == i);
+            h.pop();
+        }
+    }
+    SECTION("Fused operations"){
+        DaryHeap<4> h;
+        for(int v : values) h.push(Thing(v));
+        REQUIRE(h.push_pop(Thing(-1)).i == -1);
+        REQUIRE(h.push_pop(Thing(20)).i == 0);
+        REQUIRE(h.replace_top(Thing(30)).i == 1);
+        REQUIRE(h.size() == 10);
+        REQUIRE(h.top().i == 2);
+    }
+}
+
+TEST_CASE("Indexed heap decrease_key"){
+    IndexedDaryHeap<> h;
+    int a = h.push(50);
+    int b = h.push(40);
+    int c = h.push(30);
+    REQUIRE(h.top() == c);
+
+    h.decrease_key(a, 10);
+    REQUIRE(h.top() == a);
+    REQUIRE(h.priority(a) == 10);
+    REQUIRE_THROWS(h.decrease_key(b, 45));
+
+    REQUIRE(h.pop() == a);
+    REQUIRE_FALSE(h.contains(a));
+    REQUIRE_THROWS(h.priority(a));
+    REQUIRE(h.pop() == c);
+    REQUIRE(h.pop() == b);
+    REQUIRE(h.empty());
+}
+
+TEST_CASE("Flat hash map insert, find and erase"){
+    FlatHashMap map;
+    REQUIRE(map.empty());
+    REQUIRE(map.find(7) == nullptr);
+
+    const int n = 1000;
+    for(int i = 0; i < n; ++i){
+        REQUIRE(map.insert(i * 7, i));
+    }
+    REQUIRE_FALSE(map.insert(0, 42));
+    REQUIRE(map.size() == n);
+    REQUIRE(map.size() <= map.capacity() / 8 * 7);
+    for(int i = 0; i < n; ++i){
+        int* value = map.find(i * 7);
+        REQUIRE(value != nullptr);
+        REQUIRE(*value == i);
+    }
+    REQUIRE_FALSE(map.contains(3));
+
+    for(int i = 0; i < n; i += 2){
+        REQUIRE(map.erase(i * 7));
+    }
+    REQUIRE_FALSE(map.erase(0));
+    REQUIRE(map.size() == n / 2);
+    for(int i = 0; i < n; ++i){
+        REQUIRE(map.contains(i * 7) == (i % 2 == 1));
+    }
+
+    map[5] += 3;
+    map[5] += 4;
+    REQUIRE(*map.find(5) == 7);
+}
+
+TEST_CASE("Flat hash map reserve and churn"){
+    FlatHashMap map;
+    map.reserve(500);
+    size_t reserved = map.capacity();
+    for(int i = 0; i < 500; ++i){
+        map.insert(i, -i);
+    }
+    REQUIRE(map.capacity() == reserved);
+
+    // Repeated insert/erase must not grow the table through tombstones.
+    for(int round = 0; round < 20; ++round){
+        for(int i = 0; i < 500; ++i){
+            map.erase(i + round * 500);
+            map.insert(i + (round + 1) * 500, i);
+        }
+    }
+    REQUIRE(map.size() == 500);
+    REQUIRE(map.capacity() == reserved);
+    REQUIRE(map.contains(10000));
+
+    FlatHashSet set;
+    REQUIRE(set.insert(-5));
+    REQUIRE_FALSE(set.insert(-5));
+    REQUIRE(set.contains(-5));
+    REQUIRE(set.erase(-5));
+    REQUIRE(set.empty());
+}